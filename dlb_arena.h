@@ -9,9 +9,10 @@
 #include "dlb_vector.h"
 
 typedef struct dlb_arena {
-    char *ptr;      // Next free
-    char *end;      // End of current block
-    char **blocks;  // Linked list of allocated blocks
+    char *ptr;          // Next free
+    char *end;          // End of current block
+    char **blocks;      // Linked list of allocated blocks
+    size_t block_size;  // Optional: min size of new blocks, default DLB_ARENA_BLOCK_SIZE
 } dlb_arena;
 
 #define DLB_ARENA_ALIGNMENT 8
@@ -35,7 +36,8 @@ void dlb_arena_free(dlb_arena *arena);
 #define DLB_ARENA_IMPL_INTERNAL
 
 void dlb_arena__grow(dlb_arena *arena, size_t min_size) {
-    size_t size = ALIGN_UP(MAX(DLB_ARENA_BLOCK_SIZE, min_size),
+    size_t block_size = arena->block_size ? arena->block_size : DLB_ARENA_BLOCK_SIZE;
+    size_t size = ALIGN_UP(MAX(block_size, min_size),
                            DLB_ARENA_ALIGNMENT);
     arena->ptr = dlb_malloc(size);
     arena->end = arena->ptr + size;
@@ -59,6 +61,9 @@ void dlb_arena_free(dlb_arena *arena) {
     for (char **it = arena->blocks; it != dlb_vec_end(arena->blocks); it++) {
         free(*it);
     }
+    dlb_vec_free(arena->blocks);
+    arena->ptr = 0;
+    arena->end = 0;
 }
 
 #endif
@@ -6,55 +6,176 @@
 
 //-- header --------------------------------------------------------------------
 #include "dlb_types.h"
+#include "dlb_memory.h"
 
-// Store a bunch of flags as bits
+// Returned by the find functions when there are no more set bits
+#define DLB_BITSET_NONE UINT32_MAX
+
+// Store a bunch of flags as bits. Grows automatically on set.
 typedef struct dlb_bitset {
-    u32 size;
-    u32 *bitmaps;
+    u32 words;     // # of u64 words allocated
+    u64 *bitmaps;
 } dlb_bitset;
 
+#define dlb_bitset__word(index) ((index) >> 6)
+#define dlb_bitset__mask(index) ((u64)1 << ((index) & 0x3f))
+
+static inline void dlb_bitset__reserve_words(dlb_bitset *bitset, u32 words)
+{
+    if (words <= bitset->words) {
+        return;
+    }
+    bitset->bitmaps = (u64 *)dlb_realloc(bitset->bitmaps, (size_t)words * sizeof(*bitset->bitmaps));
+    dlb_memset(bitset->bitmaps + bitset->words, 0, (size_t)(words - bitset->words) * sizeof(*bitset->bitmaps));
+    bitset->words = words;
+}
+
+// Grow to hold at least `size` bits, new bits are cleared
 static inline void dlb_bitset_reserve(dlb_bitset *bitset, u32 size)
 {
-    bitset->size = size;
-    bitset->bitmaps = dlb_calloc(size >> 6, sizeof(*bitset->bitmaps));
+    dlb_bitset__reserve_words(bitset, (u32)(((u64)size + 63) >> 6));
 }
 
 static inline void dlb_bitset_free(dlb_bitset *bitset)
 {
     dlb_free(bitset->bitmaps);
-    bitset->size = 0;
+    bitset->bitmaps = 0;
+    bitset->words = 0;
+}
+
+// Capacity in bits
+static inline u32 dlb_bitset_size(const dlb_bitset *bitset)
+{
+    return (u32)MIN((u64)bitset->words << 6, UINT32_MAX);
+}
+
+static inline void dlb_bitset_clear_all(dlb_bitset *bitset)
+{
+    if (bitset->words) {
+        dlb_memset(bitset->bitmaps, 0, (size_t)bitset->words * sizeof(*bitset->bitmaps));
+    }
 }
 
 static inline void dlb_bitset_set(dlb_bitset *bitset, u32 index)
 {
-    u32 bitmap_idx = index >> 6;
-    if (bitmap_idx >= bitset->size) {
-        DLB_ASSERT(0);  // TODO: realloc
+    u32 bitmap_idx = dlb_bitset__word(index);
+    if (bitmap_idx >= bitset->words) {
+        // Grow geometrically so setting increasing indices is amortized O(1)
+        u64 min_size = ((u64)bitset->words << 7);
+        dlb_bitset_reserve(bitset, (u32)MIN(MAX((u64)index + 1, min_size), UINT32_MAX));
     }
-    u8 bitmap_mask = 1 << (index & 0x1f);
-    bitset->bitmaps[bitmap_idx] |= bitmap_mask;
+    bitset->bitmaps[bitmap_idx] |= dlb_bitset__mask(index);
 }
 
 static inline void dlb_bitset_unset(dlb_bitset *bitset, u32 index)
 {
-    u32 bitmap_idx = index >> 6;
-    if (bitmap_idx < bitset->size) {
-        u8 bitmap_mask = 1 << (index & 0x1f);
-        bitset->bitmaps[bitmap_idx] &= !bitmap_mask;
+    u32 bitmap_idx = dlb_bitset__word(index);
+    if (bitmap_idx < bitset->words) {
+        bitset->bitmaps[bitmap_idx] &= ~dlb_bitset__mask(index);
     }
 }
 
-static inline u8 dlb_bitset_get(dlb_bitset *bitset, u32 index)
+static inline u8 dlb_bitset_get(const dlb_bitset *bitset, u32 index)
 {
-    u32 bitmap_idx = index >> 6;
-    if (bitmap_idx < bitset->size) {
-        u8 bitmap_mask = 1 << (index & 0x1f);
-        return bitset->bitmaps[bitmap_idx] & bitmap_mask;
+    u32 bitmap_idx = dlb_bitset__word(index);
+    if (bitmap_idx < bitset->words) {
+        return (bitset->bitmaps[bitmap_idx] >> (index & 0x3f)) & 1;
     } else {
         return 0;
     }
 }
 
+// Returns # of set bits
+static inline u32 dlb_bitset_popcount(const dlb_bitset *bitset)
+{
+    u32 count = 0;
+    for (u32 i = 0; i < bitset->words; i++) {
+        count += dlb_popcount64(bitset->bitmaps[i]);
+    }
+    return count;
+}
+
+// Returns index of first set bit >= index, or DLB_BITSET_NONE
+static inline u32 dlb_bitset_find_next(const dlb_bitset *bitset, u32 index)
+{
+    u32 bitmap_idx = dlb_bitset__word(index);
+    if (bitmap_idx >= bitset->words) {
+        return DLB_BITSET_NONE;
+    }
+    // Mask off bits below index in the first word, then skip whole words
+    u64 word = bitset->bitmaps[bitmap_idx] & (~(u64)0 << (index & 0x3f));
+    while (!word) {
+        if (++bitmap_idx == bitset->words) {
+            return DLB_BITSET_NONE;
+        }
+        word = bitset->bitmaps[bitmap_idx];
+    }
+    return (bitmap_idx << 6) + dlb_ctz64(word);
+}
+
+// Returns index of first set bit, or DLB_BITSET_NONE
+static inline u32 dlb_bitset_find_first(const dlb_bitset *bitset)
+{
+    return dlb_bitset_find_next(bitset, 0);
+}
+
+// Iterate set bits in increasing order. Keeps the current word in a register
+// and strips one bit per step, so dense sets cost one tzcnt per bit and sparse
+// sets cost one load per word. Don't modify the bitset while iterating.
+//
+//   u32 index;
+//   dlb_bitset_iter it = dlb_bitset_iter_begin(&bitset);
+//   while (dlb_bitset_iter_next(&it, &index)) { ... }
+//
+typedef struct dlb_bitset_iter {
+    const u64 *bitmaps;
+    u32 words;
+    u32 bitmap_idx;
+    u64 word;  // remaining bits of bitmaps[bitmap_idx]
+} dlb_bitset_iter;
+
+static inline dlb_bitset_iter dlb_bitset_iter_begin(const dlb_bitset *bitset)
+{
+    dlb_bitset_iter it;
+    it.bitmaps = bitset->bitmaps;
+    it.words = bitset->words;
+    it.bitmap_idx = 0;
+    it.word = bitset->words ? bitset->bitmaps[0] : 0;
+    return it;
+}
+
+static inline bool dlb_bitset_iter_next(dlb_bitset_iter *it, u32 *index)
+{
+    while (!it->word) {
+        if (it->bitmap_idx + 1 >= it->words) {
+            return false;
+        }
+        it->word = it->bitmaps[++it->bitmap_idx];
+    }
+    *index = (it->bitmap_idx << 6) + dlb_ctz64(it->word);
+    it->word &= it->word - 1;  // clear lowest set bit
+    return true;
+}
+
+// Bulk set algebra, one word (or SIMD register) at a time rather than one bit.
+// Bits beyond the end of the shorter bitset are treated as zero.
+//
+// In-place: dst = dst op src, dst grows as needed
+void dlb_bitset_and(dlb_bitset *dst, const dlb_bitset *src);
+void dlb_bitset_or(dlb_bitset *dst, const dlb_bitset *src);
+void dlb_bitset_xor(dlb_bitset *dst, const dlb_bitset *src);
+void dlb_bitset_andnot(dlb_bitset *dst, const dlb_bitset *src);  // dst &= ~src
+// Into destination: dst = a op b, dst may alias a or b
+void dlb_bitset_and_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b);
+void dlb_bitset_or_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b);
+void dlb_bitset_xor_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b);
+void dlb_bitset_andnot_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b);  // a & ~b
+// Popcount of a op b, without materializing the result
+u32 dlb_bitset_and_count(const dlb_bitset *a, const dlb_bitset *b);
+u32 dlb_bitset_or_count(const dlb_bitset *a, const dlb_bitset *b);
+u32 dlb_bitset_xor_count(const dlb_bitset *a, const dlb_bitset *b);
+u32 dlb_bitset_andnot_count(const dlb_bitset *a, const dlb_bitset *b);  // |a & ~b|
+
 #endif
 //-- end of header -------------------------------------------------------------
 
@@ -68,7 +189,273 @@ static inline u8 dlb_bitset_get(dlb_bitset *bitset, u32 index)
 #ifndef DLB_BITSET_IMPL_INTERNAL
 #define DLB_BITSET_IMPL_INTERNAL
 
-// None for now, all inlined
+// Define DLB_BITSET_NO_SIMD to force the scalar fallback
+#if !defined(DLB_BITSET_NO_SIMD)
+#if defined(__AVX2__)
+#define DLB_BITSET__AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DLB_BITSET__SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
+typedef enum dlb_bitset__op {
+    DLB_BITSET__AND,
+    DLB_BITSET__OR,
+    DLB_BITSET__XOR,
+    DLB_BITSET__ANDNOT
+} dlb_bitset__op;
+
+// _mm_andnot computes ~x & y, we want x & ~y
+#if DLB_BITSET__AVX2
+static inline __m256i dlb_bitset__andnot256(__m256i x, __m256i y) { return _mm256_andnot_si256(y, x); }
+#endif
+#if DLB_BITSET__SSE2
+static inline __m128i dlb_bitset__andnot128(__m128i x, __m128i y) { return _mm_andnot_si128(y, x); }
+#endif
+
+// Each loop picks up at word `i` where the previous (wider) one left off
+#if DLB_BITSET__AVX2
+#define DLB_BITSET__OP_LOOP_AVX2(op256) \
+    for (; i + 4 <= n; i += 4) { \
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i)); \
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i)); \
+        _mm256_storeu_si256((__m256i *)(dst + i), op256(x, y)); \
+    }
+#else
+#define DLB_BITSET__OP_LOOP_AVX2(op256)
+#endif
+
+#if DLB_BITSET__SSE2
+#define DLB_BITSET__OP_LOOP_SSE2(op128) \
+    for (; i + 2 <= n; i += 2) { \
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i)); \
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i)); \
+        _mm_storeu_si128((__m128i *)(dst + i), op128(x, y)); \
+    }
+#else
+#define DLB_BITSET__OP_LOOP_SSE2(op128)
+#endif
+
+#define DLB_BITSET__OP_LOOP(op256, op128, op64) \
+    { \
+        u32 i = 0; \
+        DLB_BITSET__OP_LOOP_AVX2(op256) \
+        DLB_BITSET__OP_LOOP_SSE2(op128) \
+        for (; i < n; i++) { \
+            u64 x = a[i]; \
+            u64 y = b[i]; \
+            dst[i] = (op64); \
+        } \
+    }
+
+// dst[i] = a[i] op b[i] for i < n. Switch is outside the loops so each op gets
+// its own tight loop.
+static void dlb_bitset__op_words(dlb_bitset__op op, u64 *dst, const u64 *a, const u64 *b, u32 n)
+{
+    switch (op) {
+        case DLB_BITSET__AND:
+            DLB_BITSET__OP_LOOP(_mm256_and_si256, _mm_and_si128, x & y);
+            break;
+        case DLB_BITSET__OR:
+            DLB_BITSET__OP_LOOP(_mm256_or_si256, _mm_or_si128, x | y);
+            break;
+        case DLB_BITSET__XOR:
+            DLB_BITSET__OP_LOOP(_mm256_xor_si256, _mm_xor_si128, x ^ y);
+            break;
+        case DLB_BITSET__ANDNOT:
+            DLB_BITSET__OP_LOOP(dlb_bitset__andnot256, dlb_bitset__andnot128, x & ~y);
+            break;
+        default: DLB_ASSERT(0);
+    }
+}
+
+// AVX2 has no popcount instruction; count nibbles with a shuffle lookup table
+// and sum bytes with sad (Mula, Kurz, Lemire: "Faster Population Counts").
+// SSE2 has no byte shuffle, and scalar popcnt already keeps up with SSE2 loads,
+// so it falls through to the scalar loop.
+#if DLB_BITSET__AVX2
+#define DLB_BITSET__COUNT_LOOP_AVX2(op256) \
+    { \
+        const __m256i lookup = _mm256_setr_epi8( \
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, \
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4); \
+        const __m256i low_mask = _mm256_set1_epi8(0x0f); \
+        __m256i acc = _mm256_setzero_si256(); \
+        for (; i + 4 <= n; i += 4) { \
+            __m256i x = _mm256_loadu_si256((const __m256i *)(a + i)); \
+            __m256i y = _mm256_loadu_si256((const __m256i *)(b + i)); \
+            __m256i v = op256(x, y); \
+            __m256i lo = _mm256_and_si256(v, low_mask); \
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask); \
+            __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), \
+                                          _mm256_shuffle_epi8(lookup, hi)); \
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256())); \
+        } \
+        count += (u64)_mm256_extract_epi64(acc, 0) + (u64)_mm256_extract_epi64(acc, 1) + \
+                 (u64)_mm256_extract_epi64(acc, 2) + (u64)_mm256_extract_epi64(acc, 3); \
+    }
+#else
+#define DLB_BITSET__COUNT_LOOP_AVX2(op256)
+#endif
+
+#define DLB_BITSET__COUNT_LOOP(op256, op64) \
+    { \
+        u32 i = 0; \
+        DLB_BITSET__COUNT_LOOP_AVX2(op256) \
+        for (; i < n; i++) { \
+            u64 x = a[i]; \
+            u64 y = b[i]; \
+            count += dlb_popcount64(op64); \
+        } \
+    }
+
+// Returns popcount(a[i] op b[i]) for i < n
+static u64 dlb_bitset__count_words(dlb_bitset__op op, const u64 *a, const u64 *b, u32 n)
+{
+    u64 count = 0;
+    switch (op) {
+        case DLB_BITSET__AND:
+            DLB_BITSET__COUNT_LOOP(_mm256_and_si256, x & y);
+            break;
+        case DLB_BITSET__OR:
+            DLB_BITSET__COUNT_LOOP(_mm256_or_si256, x | y);
+            break;
+        case DLB_BITSET__XOR:
+            DLB_BITSET__COUNT_LOOP(_mm256_xor_si256, x ^ y);
+            break;
+        case DLB_BITSET__ANDNOT:
+            DLB_BITSET__COUNT_LOOP(dlb_bitset__andnot256, x & ~y);
+            break;
+        default: DLB_ASSERT(0);
+    }
+    return count;
+}
+
+static u64 dlb_bitset__popcount_words(const u64 *words, u32 n)
+{
+    u64 count = 0;
+    for (u32 i = 0; i < n; i++) {
+        count += dlb_popcount64(words[i]);
+    }
+    return count;
+}
+
+static void dlb_bitset__op_into(dlb_bitset__op op, dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b)
+{
+    u32 a_words = a->words;
+    u32 b_words = b->words;
+    u32 common = MIN(a_words, b_words);
+
+    // How many words of the result can be non-zero
+    u32 words = 0;
+    switch (op) {
+        case DLB_BITSET__AND:    words = common; break;
+        case DLB_BITSET__OR:     words = MAX(a_words, b_words); break;
+        case DLB_BITSET__XOR:    words = MAX(a_words, b_words); break;
+        case DLB_BITSET__ANDNOT: words = a_words; break;
+        default: DLB_ASSERT(0);
+    }
+
+    // NOTE: May realloc a or b's words if they alias dst, so don't grab any
+    // pointers until after this.
+    dlb_bitset__reserve_words(dst, words);
+    dlb_bitset__op_words(op, dst->bitmaps, a->bitmaps, b->bitmaps, common);
+
+    // Tail of the longer bitset is copied as-is (op with zero)
+    if (words > common) {
+        const u64 *tail = a_words > b_words ? a->bitmaps : b->bitmaps;
+        if (tail != dst->bitmaps) {
+            memcpy(dst->bitmaps + common, tail + common, (size_t)(words - common) * sizeof(*dst->bitmaps));
+        }
+    }
+    if (dst->words > words) {
+        dlb_memset(dst->bitmaps + words, 0, (size_t)(dst->words - words) * sizeof(*dst->bitmaps));
+    }
+}
+
+static u32 dlb_bitset__op_count(dlb_bitset__op op, const dlb_bitset *a, const dlb_bitset *b)
+{
+    u32 common = MIN(a->words, b->words);
+    u64 count = dlb_bitset__count_words(op, a->bitmaps, b->bitmaps, common);
+    switch (op) {
+        case DLB_BITSET__AND: {
+            break;
+        } case DLB_BITSET__OR: case DLB_BITSET__XOR: {
+            const dlb_bitset *longer = a->words > b->words ? a : b;
+            count += dlb_bitset__popcount_words(longer->bitmaps + common, longer->words - common);
+            break;
+        } case DLB_BITSET__ANDNOT: {
+            count += dlb_bitset__popcount_words(a->bitmaps + common, a->words - common);
+            break;
+        } default: {
+            DLB_ASSERT(0);
+        }
+    }
+    return (u32)MIN(count, UINT32_MAX);
+}
+
+void dlb_bitset_and(dlb_bitset *dst, const dlb_bitset *src)
+{
+    dlb_bitset__op_into(DLB_BITSET__AND, dst, dst, src);
+}
+
+void dlb_bitset_or(dlb_bitset *dst, const dlb_bitset *src)
+{
+    dlb_bitset__op_into(DLB_BITSET__OR, dst, dst, src);
+}
+
+void dlb_bitset_xor(dlb_bitset *dst, const dlb_bitset *src)
+{
+    dlb_bitset__op_into(DLB_BITSET__XOR, dst, dst, src);
+}
+
+void dlb_bitset_andnot(dlb_bitset *dst, const dlb_bitset *src)
+{
+    dlb_bitset__op_into(DLB_BITSET__ANDNOT, dst, dst, src);
+}
+
+void dlb_bitset_and_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b)
+{
+    dlb_bitset__op_into(DLB_BITSET__AND, dst, a, b);
+}
+
+void dlb_bitset_or_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b)
+{
+    dlb_bitset__op_into(DLB_BITSET__OR, dst, a, b);
+}
+
+void dlb_bitset_xor_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b)
+{
+    dlb_bitset__op_into(DLB_BITSET__XOR, dst, a, b);
+}
+
+void dlb_bitset_andnot_into(dlb_bitset *dst, const dlb_bitset *a, const dlb_bitset *b)
+{
+    dlb_bitset__op_into(DLB_BITSET__ANDNOT, dst, a, b);
+}
+
+u32 dlb_bitset_and_count(const dlb_bitset *a, const dlb_bitset *b)
+{
+    return dlb_bitset__op_count(DLB_BITSET__AND, a, b);
+}
+
+u32 dlb_bitset_or_count(const dlb_bitset *a, const dlb_bitset *b)
+{
+    return dlb_bitset__op_count(DLB_BITSET__OR, a, b);
+}
+
+u32 dlb_bitset_xor_count(const dlb_bitset *a, const dlb_bitset *b)
+{
+    return dlb_bitset__op_count(DLB_BITSET__XOR, a, b);
+}
+
+u32 dlb_bitset_andnot_count(const dlb_bitset *a, const dlb_bitset *b)
+{
+    return dlb_bitset__op_count(DLB_BITSET__ANDNOT, a, b);
+}
 
 #endif
 #endif
@@ -88,7 +475,74 @@ static void dlb_bitset_test()
     DLB_ASSERT(dlb_bitset_get(&bitset, 63) == 0);
     dlb_bitset_unset(&bitset, 31);
     DLB_ASSERT(dlb_bitset_get(&bitset, 31) == 0);
+
+    // Grow on set
+    dlb_bitset_set(&bitset, 63);
+    dlb_bitset_set(&bitset, 64);
+    dlb_bitset_set(&bitset, 100000);
+    DLB_ASSERT(dlb_bitset_size(&bitset) > 100000);
+    DLB_ASSERT(dlb_bitset_get(&bitset, 63) == 1);
+    DLB_ASSERT(dlb_bitset_get(&bitset, 64) == 1);
+    DLB_ASSERT(dlb_bitset_get(&bitset, 65) == 0);
+    DLB_ASSERT(dlb_bitset_get(&bitset, 100000) == 1);
+    DLB_ASSERT(dlb_bitset_popcount(&bitset) == 3);
+
+    // Scans
+    DLB_ASSERT(dlb_bitset_find_first(&bitset) == 63);
+    DLB_ASSERT(dlb_bitset_find_next(&bitset, 64) == 64);
+    DLB_ASSERT(dlb_bitset_find_next(&bitset, 65) == 100000);
+    DLB_ASSERT(dlb_bitset_find_next(&bitset, 100001) == DLB_BITSET_NONE);
+
+    u32 expected[] = { 63, 64, 100000 };
+    u32 count = 0;
+    u32 index;
+    dlb_bitset_iter it = dlb_bitset_iter_begin(&bitset);
+    while (dlb_bitset_iter_next(&it, &index)) {
+        DLB_ASSERT(count < ARRAY_SIZE(expected));
+        DLB_ASSERT(index == expected[count]);
+        count++;
+    }
+    DLB_ASSERT(count == ARRAY_SIZE(expected));
+
+    dlb_bitset_clear_all(&bitset);
+    DLB_ASSERT(dlb_bitset_find_first(&bitset) == DLB_BITSET_NONE);
     dlb_bitset_free(&bitset);
+
+    // Set algebra, with different lengths to exercise the SIMD, scalar and
+    // tail paths
+    dlb_bitset a = { 0 };
+    dlb_bitset b = { 0 };
+    dlb_bitset c = { 0 };
+    for (u32 i = 0; i < 1000; i += 2) dlb_bitset_set(&a, i);  // evens < 1000
+    for (u32 i = 0; i < 3000; i += 3) dlb_bitset_set(&b, i);  // multiples of 3 < 3000
+    DLB_ASSERT(dlb_bitset_and_count(&a, &b) == 167);   // multiples of 6 < 1000
+    DLB_ASSERT(dlb_bitset_or_count(&a, &b) == 1333);   // 500 + 1000 - 167
+    DLB_ASSERT(dlb_bitset_xor_count(&a, &b) == 1166);
+    DLB_ASSERT(dlb_bitset_andnot_count(&a, &b) == 333);
+    DLB_ASSERT(dlb_bitset_andnot_count(&b, &a) == 833);
+
+    dlb_bitset_and_into(&c, &a, &b);
+    DLB_ASSERT(dlb_bitset_popcount(&c) == 167);
+    DLB_ASSERT(dlb_bitset_get(&c, 996) && !dlb_bitset_get(&c, 998));
+    dlb_bitset_or_into(&c, &a, &b);
+    DLB_ASSERT(dlb_bitset_popcount(&c) == 1333);
+    dlb_bitset_xor_into(&c, &a, &b);
+    DLB_ASSERT(dlb_bitset_popcount(&c) == 1166);
+    dlb_bitset_andnot_into(&c, &b, &a);
+    DLB_ASSERT(dlb_bitset_popcount(&c) == 833);
+
+    dlb_bitset_or(&a, &b);
+    DLB_ASSERT(dlb_bitset_popcount(&a) == 1333);
+    dlb_bitset_andnot(&a, &b);
+    DLB_ASSERT(dlb_bitset_popcount(&a) == 333);
+    dlb_bitset_xor(&a, &b);
+    DLB_ASSERT(dlb_bitset_popcount(&a) == 1333);
+    dlb_bitset_and(&a, &b);
+    DLB_ASSERT(dlb_bitset_popcount(&a) == 1000);
+
+    dlb_bitset_free(&a);
+    dlb_bitset_free(&b);
+    dlb_bitset_free(&c);
 }
 
 #endif
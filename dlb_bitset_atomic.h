@@ -0,0 +1,228 @@
+#ifndef DLB_BITSET_ATOMIC_H
+#define DLB_BITSET_ATOMIC_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Fixed-capacity bitset that many threads can modify concurrently without a
+// lock, e.g. marking visited nodes in a parallel graph traversal:
+//
+//   if (!dlb_bitset_atomic_test_and_set(&visited, node, std::memory_order_relaxed)) {
+//       // This thread claimed the node
+//   }
+//
+// Use relaxed ordering when the bit itself is the only shared data. Use
+// acquire/release (or acq_rel) when setting a bit publishes other data that
+// the thread observing the bit will read.
+//
+// Clearing between phases: each worker calls dlb_bitset_atomic_clear_part with
+// its own part index, then all workers must pass a barrier (thread join,
+// std::barrier, etc.) before the next phase touches the bitset. Parts are
+// split on cache line boundaries so workers never write to the same line.
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_bitset.h"
+#include <atomic>
+#include <new>
+
+typedef struct dlb_bitset_atomic {
+    u32 size;   // capacity in bits
+    u32 words;  // # of u64 words
+    std::atomic<u64> *bitmaps;  // cache line aligned, padded to whole lines
+} dlb_bitset_atomic;
+
+void dlb_bitset_atomic_init(dlb_bitset_atomic *bitset, u32 size);
+void dlb_bitset_atomic_free(dlb_bitset_atomic *bitset);
+
+// Returns 0/1
+u8 dlb_bitset_atomic_get(const dlb_bitset_atomic *bitset, u32 index, std::memory_order order);
+// Set bit, returns previous value (0/1)
+u8 dlb_bitset_atomic_test_and_set(dlb_bitset_atomic *bitset, u32 index, std::memory_order order);
+// Clear bit, returns previous value (0/1)
+u8 dlb_bitset_atomic_test_and_clear(dlb_bitset_atomic *bitset, u32 index, std::memory_order order);
+// Whole-word operations, return the previous word
+u64 dlb_bitset_atomic_fetch_or_word(dlb_bitset_atomic *bitset, u32 word_idx, u64 mask, std::memory_order order);
+u64 dlb_bitset_atomic_fetch_and_word(dlb_bitset_atomic *bitset, u32 word_idx, u64 mask, std::memory_order order);
+
+// Clear part `part` of `parts` equal-ish slices. Not synchronized with
+// concurrent setters, see documentation above.
+void dlb_bitset_atomic_clear_part(dlb_bitset_atomic *bitset, u32 part, u32 parts);
+// Single-threaded convenience for clear_part(bitset, 0, 1)
+void dlb_bitset_atomic_clear_all(dlb_bitset_atomic *bitset);
+
+// Relaxed snapshots; only exact if no other thread is modifying the bitset
+u32 dlb_bitset_atomic_popcount(const dlb_bitset_atomic *bitset);
+void dlb_bitset_atomic_copy_to(const dlb_bitset_atomic *bitset, dlb_bitset *dst);
+
+void dlb_bitset_atomic_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_BITSET_ATOMIC_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_BITSET_ATOMIC_IMPLEMENTATION
+#ifndef DLB_BITSET_ATOMIC_IMPL_INTERNAL
+#define DLB_BITSET_ATOMIC_IMPL_INTERNAL
+
+#define DLB_BITSET_ATOMIC__LINE_BYTES 64
+// u64 words per cache line
+#define DLB_BITSET_ATOMIC__LINE_WORDS (DLB_BITSET_ATOMIC__LINE_BYTES / 8)
+
+// Loads can't have release semantics, strip them from read-modify-write orders
+static inline std::memory_order dlb_bitset_atomic__load_order(std::memory_order order)
+{
+    switch (order) {
+        case std::memory_order_release: return std::memory_order_relaxed;
+        case std::memory_order_acq_rel: return std::memory_order_acquire;
+        default: return order;
+    }
+}
+
+void dlb_bitset_atomic_init(dlb_bitset_atomic *bitset, u32 size)
+{
+    DLB_ASSERT(size);
+    bitset->size = size;
+    bitset->words = (u32)(((u64)size + 63) >> 6);
+    // Aligned and padded to whole cache lines, so clear_part's line-sized
+    // parts really are separate lines
+    size_t words = ALIGN_UP((size_t)bitset->words, DLB_BITSET_ATOMIC__LINE_WORDS);
+    void *memory = ::operator new[](words * sizeof(std::atomic<u64>), std::align_val_t(DLB_BITSET_ATOMIC__LINE_BYTES));
+    bitset->bitmaps = (std::atomic<u64> *)memory;
+    for (size_t i = 0; i < words; i++) {
+        new (&bitset->bitmaps[i]) std::atomic<u64>(0);
+    }
+}
+
+void dlb_bitset_atomic_free(dlb_bitset_atomic *bitset)
+{
+    // std::atomic<u64> is trivially destructible, just release the memory
+    ::operator delete[](bitset->bitmaps, std::align_val_t(DLB_BITSET_ATOMIC__LINE_BYTES));
+    bitset->bitmaps = 0;
+    bitset->words = 0;
+    bitset->size = 0;
+}
+
+u8 dlb_bitset_atomic_get(const dlb_bitset_atomic *bitset, u32 index, std::memory_order order)
+{
+    DLB_ASSERT(index < bitset->size);
+    u64 word = bitset->bitmaps[index >> 6].load(dlb_bitset_atomic__load_order(order));
+    return (word >> (index & 0x3f)) & 1;
+}
+
+u8 dlb_bitset_atomic_test_and_set(dlb_bitset_atomic *bitset, u32 index, std::memory_order order)
+{
+    DLB_ASSERT(index < bitset->size);
+    std::atomic<u64> *word = &bitset->bitmaps[index >> 6];
+    u64 mask = (u64)1 << (index & 0x3f);
+    // Most calls in a traversal hit already-set bits; a plain load keeps the
+    // cache line shared instead of taking it exclusive for a no-op RMW
+    if (word->load(dlb_bitset_atomic__load_order(order)) & mask) {
+        return 1;
+    }
+    return (word->fetch_or(mask, order) & mask) != 0;
+}
+
+u8 dlb_bitset_atomic_test_and_clear(dlb_bitset_atomic *bitset, u32 index, std::memory_order order)
+{
+    DLB_ASSERT(index < bitset->size);
+    std::atomic<u64> *word = &bitset->bitmaps[index >> 6];
+    u64 mask = (u64)1 << (index & 0x3f);
+    if (!(word->load(dlb_bitset_atomic__load_order(order)) & mask)) {
+        return 0;
+    }
+    return (word->fetch_and(~mask, order) & mask) != 0;
+}
+
+u64 dlb_bitset_atomic_fetch_or_word(dlb_bitset_atomic *bitset, u32 word_idx, u64 mask, std::memory_order order)
+{
+    DLB_ASSERT(word_idx < bitset->words);
+    return bitset->bitmaps[word_idx].fetch_or(mask, order);
+}
+
+u64 dlb_bitset_atomic_fetch_and_word(dlb_bitset_atomic *bitset, u32 word_idx, u64 mask, std::memory_order order)
+{
+    DLB_ASSERT(word_idx < bitset->words);
+    return bitset->bitmaps[word_idx].fetch_and(mask, order);
+}
+
+void dlb_bitset_atomic_clear_part(dlb_bitset_atomic *bitset, u32 part, u32 parts)
+{
+    DLB_ASSERT(parts && part < parts);
+    // Split on cache lines so neighboring parts don't false-share
+    u64 lines = ((u64)bitset->words + DLB_BITSET_ATOMIC__LINE_WORDS - 1) / DLB_BITSET_ATOMIC__LINE_WORDS;
+    u64 first = (lines * part / parts) * DLB_BITSET_ATOMIC__LINE_WORDS;
+    u64 last = (lines * (part + 1) / parts) * DLB_BITSET_ATOMIC__LINE_WORDS;
+    last = MIN(last, bitset->words);
+    for (u64 i = first; i < last; i++) {
+        bitset->bitmaps[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void dlb_bitset_atomic_clear_all(dlb_bitset_atomic *bitset)
+{
+    dlb_bitset_atomic_clear_part(bitset, 0, 1);
+}
+
+u32 dlb_bitset_atomic_popcount(const dlb_bitset_atomic *bitset)
+{
+    u32 count = 0;
+    for (u32 i = 0; i < bitset->words; i++) {
+        count += dlb_popcount64(bitset->bitmaps[i].load(std::memory_order_relaxed));
+    }
+    return count;
+}
+
+void dlb_bitset_atomic_copy_to(const dlb_bitset_atomic *bitset, dlb_bitset *dst)
+{
+    dlb_bitset_reserve(dst, bitset->size);
+    dlb_bitset_clear_all(dst);
+    for (u32 i = 0; i < bitset->words; i++) {
+        dst->bitmaps[i] = bitset->bitmaps[i].load(std::memory_order_relaxed);
+    }
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_BITSET_ATOMIC_TEST
+
+void dlb_bitset_atomic_test()
+{
+    dlb_bitset_atomic bitset = { 0 };
+    dlb_bitset_atomic_init(&bitset, 1000);
+    DLB_ASSERT(!dlb_bitset_atomic_test_and_set(&bitset, 999, std::memory_order_relaxed));
+    DLB_ASSERT(dlb_bitset_atomic_test_and_set(&bitset, 999, std::memory_order_relaxed));
+    DLB_ASSERT(((uintptr_t)bitset.bitmaps & (DLB_BITSET_ATOMIC__LINE_BYTES - 1)) == 0);
+    DLB_ASSERT(dlb_bitset_atomic_get(&bitset, 999, std::memory_order_acquire));
+    DLB_ASSERT(dlb_bitset_atomic_test_and_clear(&bitset, 999, std::memory_order_acq_rel));
+    DLB_ASSERT(!dlb_bitset_atomic_test_and_clear(&bitset, 999, std::memory_order_acq_rel));
+
+    DLB_ASSERT(dlb_bitset_atomic_fetch_or_word(&bitset, 2, 0xF0, std::memory_order_release) == 0);
+    DLB_ASSERT(dlb_bitset_atomic_fetch_or_word(&bitset, 2, 0x0F, std::memory_order_release) == 0xF0);
+    DLB_ASSERT(dlb_bitset_atomic_popcount(&bitset) == 8);
+    DLB_ASSERT(dlb_bitset_atomic_get(&bitset, 128, std::memory_order_relaxed));
+
+    dlb_bitset copy = { 0 };
+    dlb_bitset_atomic_copy_to(&bitset, &copy);
+    DLB_ASSERT(dlb_bitset_popcount(&copy) == 8);
+    dlb_bitset_free(&copy);
+
+    // Every part together clears everything
+    for (u32 part = 0; part < 3; part++) {
+        dlb_bitset_atomic_clear_part(&bitset, part, 3);
+    }
+    DLB_ASSERT(dlb_bitset_atomic_popcount(&bitset) == 0);
+    dlb_bitset_atomic_free(&bitset);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
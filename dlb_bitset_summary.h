@@ -0,0 +1,295 @@
+#ifndef DLB_BITSET_SUMMARY_H
+#define DLB_BITSET_SUMMARY_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Fixed-capacity bitset with summary levels for fast searching, e.g. tracking
+// free slots in a large table.
+//
+// Level 0 holds the bits. Each bit of a level above summarizes one u64 word of
+// the level below it, once for "word has any set bit" and once for "word has
+// any clear bit". Levels are added until the top level is a single word, so
+// each find costs one tzcnt per level (3 summary levels above the bits cover
+// 2^24 bits, 5 cover 2^32) no matter how full or empty the set is. Set/unset only touch the levels
+// above them when a word changes between empty/non-empty or full/non-full.
+//
+//   dlb_bitset_summary slots = { 0 };
+//   dlb_bitset_summary_init(&slots, 1000000);
+//   u32 free_slot = dlb_bitset_summary_find_first_clear(&slots);
+//   dlb_bitset_summary_set(&slots, free_slot);
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_memory.h"
+#include "dlb_bitset.h"
+
+// 64^6 > 2^32
+#define DLB_BITSET_SUMMARY_MAX_LEVELS 6
+
+typedef struct dlb_bitset_summary {
+    u32 size;    // capacity in bits
+    u32 levels;  // # of summary levels above the bits
+    u64 *bits;
+    // Per-level words, [0] summarizes bits, [levels - 1] is a single word
+    u64 *any_set[DLB_BITSET_SUMMARY_MAX_LEVELS];    // bit = word below is non-empty
+    u64 *any_clear[DLB_BITSET_SUMMARY_MAX_LEVELS];  // bit = word below is non-full
+    u32 words[DLB_BITSET_SUMMARY_MAX_LEVELS + 1];   // # of words in bits, then each level
+} dlb_bitset_summary;
+
+void dlb_bitset_summary_init(dlb_bitset_summary *bitset, u32 size);
+void dlb_bitset_summary_free(dlb_bitset_summary *bitset);
+void dlb_bitset_summary_set(dlb_bitset_summary *bitset, u32 index);
+void dlb_bitset_summary_unset(dlb_bitset_summary *bitset, u32 index);
+// Returns index of first set bit >= index, or DLB_BITSET_NONE
+u32 dlb_bitset_summary_find_next_set(const dlb_bitset_summary *bitset, u32 index);
+// Returns index of first clear bit >= index, or DLB_BITSET_NONE
+u32 dlb_bitset_summary_find_next_clear(const dlb_bitset_summary *bitset, u32 index);
+
+static inline u8 dlb_bitset_summary_get(const dlb_bitset_summary *bitset, u32 index)
+{
+    DLB_ASSERT(index < bitset->size);
+    return (bitset->bits[index >> 6] >> (index & 0x3f)) & 1;
+}
+
+static inline u32 dlb_bitset_summary_find_first_set(const dlb_bitset_summary *bitset)
+{
+    return dlb_bitset_summary_find_next_set(bitset, 0);
+}
+
+static inline u32 dlb_bitset_summary_find_first_clear(const dlb_bitset_summary *bitset)
+{
+    return dlb_bitset_summary_find_next_clear(bitset, 0);
+}
+
+void dlb_bitset_summary_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_BITSET_SUMMARY_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_BITSET_SUMMARY_IMPLEMENTATION
+#ifndef DLB_BITSET_SUMMARY_IMPL_INTERNAL
+#define DLB_BITSET_SUMMARY_IMPL_INTERNAL
+
+void dlb_bitset_summary_init(dlb_bitset_summary *bitset, u32 size)
+{
+    DLB_ASSERT(size);
+    dlb_memset(bitset, 0, sizeof(*bitset));
+    bitset->size = size;
+    bitset->words[0] = (u32)(((u64)size + 63) >> 6);
+    bitset->bits = (u64 *)dlb_calloc(bitset->words[0], sizeof(u64));
+
+    // Add levels until one word summarizes everything below it
+    u32 words = bitset->words[0];
+    do {
+        DLB_ASSERT(bitset->levels < DLB_BITSET_SUMMARY_MAX_LEVELS);
+        words = (words + 63) >> 6;
+        bitset->words[bitset->levels + 1] = words;
+        bitset->any_set[bitset->levels] = (u64 *)dlb_calloc(words, sizeof(u64));
+        bitset->any_clear[bitset->levels] = (u64 *)dlb_calloc(words, sizeof(u64));
+        bitset->levels++;
+    } while (words > 1);
+
+    // Every word starts out non-full. Padding bits past the last word of each
+    // level stay clear so they're never found.
+    for (u32 level = 0; level < bitset->levels; level++) {
+        u32 below = bitset->words[level];
+        for (u32 i = 0; i < below; i++) {
+            bitset->any_clear[level][i >> 6] |= (u64)1 << (i & 0x3f);
+        }
+    }
+}
+
+void dlb_bitset_summary_free(dlb_bitset_summary *bitset)
+{
+    dlb_free(bitset->bits);
+    for (u32 level = 0; level < bitset->levels; level++) {
+        dlb_free(bitset->any_set[level]);
+        dlb_free(bitset->any_clear[level]);
+    }
+    dlb_memset(bitset, 0, sizeof(*bitset));
+}
+
+// Propagate a word's empty/full state changes up through the summaries
+static void dlb_bitset_summary__update(dlb_bitset_summary *bitset, u32 word_idx, u64 old_word, u64 new_word)
+{
+    bool non_empty = new_word != 0;
+    bool non_full = new_word != ~(u64)0;
+    bool set_changed = (old_word != 0) != non_empty;
+    bool clear_changed = (old_word != ~(u64)0) != non_full;
+
+    // Above level 0, a summary word is "non-empty"/"non-full" if it's non-zero
+    for (u32 level = 0; level < bitset->levels && (set_changed || clear_changed); level++) {
+        u32 parent = word_idx >> 6;
+        u64 mask = (u64)1 << (word_idx & 0x3f);
+
+        if (set_changed) {
+            u64 old_summary = bitset->any_set[level][parent];
+            u64 new_summary = non_empty ? old_summary | mask : old_summary & ~mask;
+            bitset->any_set[level][parent] = new_summary;
+            non_empty = new_summary != 0;
+            set_changed = (old_summary != 0) != non_empty;
+        }
+        if (clear_changed) {
+            u64 old_summary = bitset->any_clear[level][parent];
+            u64 new_summary = non_full ? old_summary | mask : old_summary & ~mask;
+            bitset->any_clear[level][parent] = new_summary;
+            non_full = new_summary != 0;
+            clear_changed = (old_summary != 0) != non_full;
+        }
+        word_idx = parent;
+    }
+}
+
+void dlb_bitset_summary_set(dlb_bitset_summary *bitset, u32 index)
+{
+    DLB_ASSERT(index < bitset->size);
+    u32 word_idx = index >> 6;
+    u64 old_word = bitset->bits[word_idx];
+    u64 new_word = old_word | ((u64)1 << (index & 0x3f));
+    if (new_word != old_word) {
+        bitset->bits[word_idx] = new_word;
+        dlb_bitset_summary__update(bitset, word_idx, old_word, new_word);
+    }
+}
+
+void dlb_bitset_summary_unset(dlb_bitset_summary *bitset, u32 index)
+{
+    DLB_ASSERT(index < bitset->size);
+    u32 word_idx = index >> 6;
+    u64 old_word = bitset->bits[word_idx];
+    u64 new_word = old_word & ~((u64)1 << (index & 0x3f));
+    if (new_word != old_word) {
+        bitset->bits[word_idx] = new_word;
+        dlb_bitset_summary__update(bitset, word_idx, old_word, new_word);
+    }
+}
+
+// Walk down from level `level` (word `word_idx`) to the first candidate bit,
+// using `summary` to pick children. Returns bit index in the level below the
+// bottom summary, i.e. a word index into `bits`.
+static u32 dlb_bitset_summary__descend(u64 *const *summary, u32 level, u32 word_idx, u64 word)
+{
+    for (;;) {
+        u32 child = (word_idx << 6) + dlb_ctz64(word);
+        if (level == 0) {
+            return child;
+        }
+        level--;
+        word_idx = child;
+        word = summary[level][word_idx];
+    }
+}
+
+// Returns index of the first word >= word_idx whose summary bit is set, or
+// UINT32_MAX. Climbs until a level has a candidate at or after the position,
+// then descends taking the first candidate at each level.
+static u32 dlb_bitset_summary__next_word(const dlb_bitset_summary *bitset, u64 *const *summary, u32 word_idx)
+{
+    for (u32 level = 0; level < bitset->levels; level++) {
+        u32 parent = word_idx >> 6;
+        if (parent >= bitset->words[level + 1]) {
+            return UINT32_MAX;
+        }
+        u64 word = summary[level][parent] & (~(u64)0 << (word_idx & 0x3f));
+        if (word) {
+            return dlb_bitset_summary__descend(summary, level, parent, word);
+        }
+        // Nothing left in this parent word, continue from the next one
+        word_idx = parent + 1;
+    }
+    return UINT32_MAX;
+}
+
+u32 dlb_bitset_summary_find_next_set(const dlb_bitset_summary *bitset, u32 index)
+{
+    if (index >= bitset->size) {
+        return DLB_BITSET_NONE;
+    }
+    u32 word_idx = index >> 6;
+    u64 word = bitset->bits[word_idx] & (~(u64)0 << (index & 0x3f));
+    if (!word) {
+        word_idx = dlb_bitset_summary__next_word(bitset, bitset->any_set, word_idx + 1);
+        if (word_idx == UINT32_MAX) {
+            return DLB_BITSET_NONE;
+        }
+        word = bitset->bits[word_idx];
+    }
+    return (word_idx << 6) + dlb_ctz64(word);
+}
+
+u32 dlb_bitset_summary_find_next_clear(const dlb_bitset_summary *bitset, u32 index)
+{
+    if (index >= bitset->size) {
+        return DLB_BITSET_NONE;
+    }
+    u32 word_idx = index >> 6;
+    u64 word = ~bitset->bits[word_idx] & (~(u64)0 << (index & 0x3f));
+    if (!word) {
+        word_idx = dlb_bitset_summary__next_word(bitset, bitset->any_clear, word_idx + 1);
+        if (word_idx == UINT32_MAX) {
+            return DLB_BITSET_NONE;
+        }
+        word = ~bitset->bits[word_idx];
+    }
+    u32 result = (word_idx << 6) + dlb_ctz64(word);
+    // Clear padding bits in the last word don't count
+    return result < bitset->size ? result : DLB_BITSET_NONE;
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_BITSET_SUMMARY_TEST
+
+void dlb_bitset_summary_test()
+{
+    dlb_bitset_summary slots = { 0 };
+    dlb_bitset_summary_init(&slots, 300000);
+    DLB_ASSERT(slots.levels == 3);
+    DLB_ASSERT(dlb_bitset_summary_find_first_set(&slots) == DLB_BITSET_NONE);
+    DLB_ASSERT(dlb_bitset_summary_find_first_clear(&slots) == 0);
+
+    // Allocate every slot in order
+    for (u32 i = 0; i < slots.size; i++) {
+        u32 slot = dlb_bitset_summary_find_first_clear(&slots);
+        DLB_ASSERT(slot == i);
+        dlb_bitset_summary_set(&slots, slot);
+    }
+    DLB_ASSERT(dlb_bitset_summary_find_first_clear(&slots) == DLB_BITSET_NONE);
+    DLB_ASSERT(dlb_bitset_summary_find_first_set(&slots) == 0);
+
+    // Free a few far apart slots, they should be found in order
+    dlb_bitset_summary_unset(&slots, 299999);
+    dlb_bitset_summary_unset(&slots, 70000);
+    dlb_bitset_summary_unset(&slots, 5);
+    DLB_ASSERT(dlb_bitset_summary_find_first_clear(&slots) == 5);
+    DLB_ASSERT(dlb_bitset_summary_find_next_clear(&slots, 6) == 70000);
+    DLB_ASSERT(dlb_bitset_summary_find_next_clear(&slots, 70001) == 299999);
+    DLB_ASSERT(dlb_bitset_summary_get(&slots, 70000) == 0);
+    DLB_ASSERT(dlb_bitset_summary_get(&slots, 70001) == 1);
+
+    // Clear everything, then set a few
+    for (u32 i = 0; i < slots.size; i++) {
+        dlb_bitset_summary_unset(&slots, i);
+    }
+    dlb_bitset_summary_set(&slots, 4096);
+    dlb_bitset_summary_set(&slots, 262144);
+    DLB_ASSERT(dlb_bitset_summary_find_first_set(&slots) == 4096);
+    DLB_ASSERT(dlb_bitset_summary_find_next_set(&slots, 4097) == 262144);
+    DLB_ASSERT(dlb_bitset_summary_find_next_set(&slots, 262145) == DLB_BITSET_NONE);
+
+    dlb_bitset_summary_free(&slots);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
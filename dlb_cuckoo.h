@@ -0,0 +1,302 @@
+#ifndef DLB_CUCKOO_H
+#define DLB_CUCKOO_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Cuckoo filter (Fan et al.): approximate set membership with deletion.
+//
+// Each key stores a small fingerprint in one of two 4-slot buckets. The
+// second bucket is derived from the first and the fingerprint alone (partial-
+// key cuckoo hashing), i2 = i1 ^ hash(fp), so entries can be relocated without
+// the original key. A lookup reads at most two buckets (two cache lines).
+//
+// False-positive rate is about 8 / 2^DLB_CUCKOO_FINGERPRINT_BITS: ~3% with
+// 8-bit and ~0.01% with 16-bit fingerprints.
+//
+// Only delete keys that were inserted. Deleting a key that was never added
+// may remove another key's matching fingerprint. Inserting the same key twice
+// stores two copies; it then needs two deletes.
+//
+// Requires DLB_MURMUR3_IMPLEMENTATION and DLB_RAND_IMPLEMENTATION in the same
+// translation unit.
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_memory.h"
+#include "dlb_murmur3.h"
+#include "dlb_rand.h"
+
+// 8 or 16
+#ifndef DLB_CUCKOO_FINGERPRINT_BITS
+#define DLB_CUCKOO_FINGERPRINT_BITS 8
+#endif
+
+// A bucket is one word of 4 packed fingerprints, 0 = empty slot
+#if DLB_CUCKOO_FINGERPRINT_BITS == 8
+typedef u8 dlb_cuckoo_fp;
+typedef u32 dlb_cuckoo_bucket;
+#elif DLB_CUCKOO_FINGERPRINT_BITS == 16
+typedef u16 dlb_cuckoo_fp;
+typedef u64 dlb_cuckoo_bucket;
+#else
+#error "DLB_CUCKOO_FINGERPRINT_BITS must be 8 or 16"
+#endif
+
+typedef struct dlb_cuckoo {
+    u32 bucket_count;  // power of 2
+    u32 count;         // # of stored fingerprints, including victim
+    dlb_cuckoo_bucket *buckets;
+    // Fingerprint evicted by an insert that ran out of kicks. While set, the
+    // filter is full and further inserts fail.
+    u32 victim_index;
+    dlb_cuckoo_fp victim_fp;
+    dlb_rand32_t rng;  // picks which entry to kick
+} dlb_cuckoo;
+
+// Size for at least `capacity` keys
+void dlb_cuckoo_init(dlb_cuckoo *filter, u32 capacity);
+void dlb_cuckoo_free(dlb_cuckoo *filter);
+// Returns false if the filter is full (key was not added)
+bool dlb_cuckoo_insert(dlb_cuckoo *filter, const void *key, size_t klen);
+// False = definitely absent, true = probably present
+bool dlb_cuckoo_contains(const dlb_cuckoo *filter, const void *key, size_t klen);
+// Returns false if no matching fingerprint was found
+bool dlb_cuckoo_delete(dlb_cuckoo *filter, const void *key, size_t klen);
+// Fraction of slots in use, inserts start failing around 0.95
+float dlb_cuckoo_load_factor(const dlb_cuckoo *filter);
+
+void dlb_cuckoo_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_CUCKOO_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_CUCKOO_IMPLEMENTATION
+#ifndef DLB_CUCKOO_IMPL_INTERNAL
+#define DLB_CUCKOO_IMPL_INTERNAL
+
+#define DLB_CUCKOO__SLOTS 4
+#define DLB_CUCKOO__MAX_KICKS 500
+#define DLB_CUCKOO__FP_MASK (((dlb_cuckoo_bucket)1 << DLB_CUCKOO_FINGERPRINT_BITS) - 1)
+// Lowest / highest bit of every slot, for SWAR slot compares
+#define DLB_CUCKOO__LOW ((dlb_cuckoo_bucket)~(dlb_cuckoo_bucket)0 / DLB_CUCKOO__FP_MASK)
+#define DLB_CUCKOO__HIGH (DLB_CUCKOO__LOW << (DLB_CUCKOO_FINGERPRINT_BITS - 1))
+
+void dlb_cuckoo_init(dlb_cuckoo *filter, u32 capacity)
+{
+    // Aim for 95% load at capacity, bucket count must be a power of 2 for the
+    // xor in dlb_cuckoo__alt to stay in range
+    u64 min_buckets = ((u64)capacity * 100 / 95 + DLB_CUCKOO__SLOTS - 1) / DLB_CUCKOO__SLOTS;
+    u64 buckets = 1;
+    while (buckets < min_buckets) {
+        buckets <<= 1;
+    }
+    DLB_ASSERT(buckets <= ((u64)1 << 31));
+    filter->bucket_count = (u32)buckets;
+    filter->count = 0;
+    filter->buckets = (dlb_cuckoo_bucket *)dlb_calloc(filter->bucket_count, sizeof(*filter->buckets));
+    filter->victim_index = 0;
+    filter->victim_fp = 0;
+    dlb_rand32_seed_r(&filter->rng, 0x853c49e6748fea9bULL, (u64)(size_t)filter);
+}
+
+void dlb_cuckoo_free(dlb_cuckoo *filter)
+{
+    dlb_free(filter->buckets);
+    dlb_memset(filter, 0, sizeof(*filter));
+}
+
+static inline dlb_cuckoo_fp dlb_cuckoo__slot(dlb_cuckoo_bucket bucket, u32 slot)
+{
+    return (dlb_cuckoo_fp)((bucket >> (slot * DLB_CUCKOO_FINGERPRINT_BITS)) & DLB_CUCKOO__FP_MASK);
+}
+
+static inline void dlb_cuckoo__slot_set(dlb_cuckoo_bucket *bucket, u32 slot, dlb_cuckoo_fp fp)
+{
+    u32 shift = slot * DLB_CUCKOO_FINGERPRINT_BITS;
+    *bucket = (*bucket & ~(DLB_CUCKOO__FP_MASK << shift)) | ((dlb_cuckoo_bucket)fp << shift);
+}
+
+// True if any slot of bucket equals fp (classic "has zero byte" trick)
+static inline bool dlb_cuckoo__has(dlb_cuckoo_bucket bucket, dlb_cuckoo_fp fp)
+{
+    dlb_cuckoo_bucket x = bucket ^ (DLB_CUCKOO__LOW * fp);
+    return ((x - DLB_CUCKOO__LOW) & ~x & DLB_CUCKOO__HIGH) != 0;
+}
+
+static inline void dlb_cuckoo__hash(const dlb_cuckoo *filter, const void *key, size_t klen, u32 *index, dlb_cuckoo_fp *fp)
+{
+    u32 hash = dlb_murmur3(key, klen);
+    *index = hash & (filter->bucket_count - 1);
+    // Fingerprint from the high bits of a multiplicative remix so it stays
+    // independent of the low bits that picked the bucket
+    dlb_cuckoo_fp f = (dlb_cuckoo_fp)((hash * 0x9e3779b1U) >> (32 - DLB_CUCKOO_FINGERPRINT_BITS));
+    *fp = f ? f : 1;
+}
+
+static inline u32 dlb_cuckoo__alt(const dlb_cuckoo *filter, u32 index, dlb_cuckoo_fp fp)
+{
+    return (index ^ ((u32)fp * 0x5bd1e995U)) & (filter->bucket_count - 1);
+}
+
+static bool dlb_cuckoo__try_place(dlb_cuckoo *filter, u32 index, dlb_cuckoo_fp fp)
+{
+    dlb_cuckoo_bucket *bucket = &filter->buckets[index];
+    for (u32 slot = 0; slot < DLB_CUCKOO__SLOTS; slot++) {
+        if (!dlb_cuckoo__slot(*bucket, slot)) {
+            dlb_cuckoo__slot_set(bucket, slot, fp);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Place fp in bucket index or its alternate, kicking entries around if both
+// are full. Always succeeds; on too many kicks the last evictee becomes the
+// victim.
+static void dlb_cuckoo__place(dlb_cuckoo *filter, u32 index, dlb_cuckoo_fp fp)
+{
+    u32 alt = dlb_cuckoo__alt(filter, index, fp);
+    if (dlb_cuckoo__try_place(filter, index, fp) || dlb_cuckoo__try_place(filter, alt, fp)) {
+        return;
+    }
+    u32 rand = dlb_rand32u_r(&filter->rng);
+    index = (rand & 1) ? index : alt;
+    for (u32 kick = 0; kick < DLB_CUCKOO__MAX_KICKS; kick++) {
+        u32 slot = dlb_rand32u_r(&filter->rng) % DLB_CUCKOO__SLOTS;
+        dlb_cuckoo_fp evicted = dlb_cuckoo__slot(filter->buckets[index], slot);
+        dlb_cuckoo__slot_set(&filter->buckets[index], slot, fp);
+        fp = evicted;
+        index = dlb_cuckoo__alt(filter, index, fp);
+        if (dlb_cuckoo__try_place(filter, index, fp)) {
+            return;
+        }
+    }
+    filter->victim_index = index;
+    filter->victim_fp = fp;
+}
+
+bool dlb_cuckoo_insert(dlb_cuckoo *filter, const void *key, size_t klen)
+{
+    if (filter->victim_fp) {
+        return false;
+    }
+    u32 index;
+    dlb_cuckoo_fp fp;
+    dlb_cuckoo__hash(filter, key, klen, &index, &fp);
+    dlb_cuckoo__place(filter, index, fp);
+    filter->count++;
+    return true;
+}
+
+bool dlb_cuckoo_contains(const dlb_cuckoo *filter, const void *key, size_t klen)
+{
+    u32 i1;
+    dlb_cuckoo_fp fp;
+    dlb_cuckoo__hash(filter, key, klen, &i1, &fp);
+    u32 i2 = dlb_cuckoo__alt(filter, i1, fp);
+    if (dlb_cuckoo__has(filter->buckets[i1], fp) || dlb_cuckoo__has(filter->buckets[i2], fp)) {
+        return true;
+    }
+    return filter->victim_fp == fp && (filter->victim_index == i1 || filter->victim_index == i2);
+}
+
+static bool dlb_cuckoo__remove(dlb_cuckoo *filter, u32 index, dlb_cuckoo_fp fp)
+{
+    dlb_cuckoo_bucket *bucket = &filter->buckets[index];
+    for (u32 slot = 0; slot < DLB_CUCKOO__SLOTS; slot++) {
+        if (dlb_cuckoo__slot(*bucket, slot) == fp) {
+            dlb_cuckoo__slot_set(bucket, slot, 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool dlb_cuckoo_delete(dlb_cuckoo *filter, const void *key, size_t klen)
+{
+    u32 i1;
+    dlb_cuckoo_fp fp;
+    dlb_cuckoo__hash(filter, key, klen, &i1, &fp);
+    u32 i2 = dlb_cuckoo__alt(filter, i1, fp);
+
+    if (dlb_cuckoo__remove(filter, i1, fp) || dlb_cuckoo__remove(filter, i2, fp)) {
+        filter->count--;
+        // Freed a slot, give the victim another chance at a real home
+        if (filter->victim_fp) {
+            dlb_cuckoo_fp victim = filter->victim_fp;
+            filter->victim_fp = 0;
+            dlb_cuckoo__place(filter, filter->victim_index, victim);
+        }
+        return true;
+    }
+    if (filter->victim_fp == fp && (filter->victim_index == i1 || filter->victim_index == i2)) {
+        filter->victim_fp = 0;
+        filter->count--;
+        return true;
+    }
+    return false;
+}
+
+float dlb_cuckoo_load_factor(const dlb_cuckoo *filter)
+{
+    return (float)filter->count / ((float)filter->bucket_count * DLB_CUCKOO__SLOTS);
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_CUCKOO_TEST
+
+void dlb_cuckoo_test()
+{
+    const u32 count = 10000;
+    dlb_cuckoo filter = { 0 };
+    dlb_cuckoo_init(&filter, count);
+
+    for (u32 i = 0; i < count; i++) {
+        DLB_ASSERT(dlb_cuckoo_insert(&filter, &i, sizeof(i)));
+    }
+    DLB_ASSERT(filter.count == count);
+    DLB_ASSERT(dlb_cuckoo_load_factor(&filter) > 0.5f);
+    for (u32 i = 0; i < count; i++) {
+        DLB_ASSERT(dlb_cuckoo_contains(&filter, &i, sizeof(i)));
+    }
+
+    // Delete the even keys, odd keys must survive
+    for (u32 i = 0; i < count; i += 2) {
+        DLB_ASSERT(dlb_cuckoo_delete(&filter, &i, sizeof(i)));
+    }
+    DLB_ASSERT(filter.count == count / 2);
+    for (u32 i = 1; i < count; i += 2) {
+        DLB_ASSERT(dlb_cuckoo_contains(&filter, &i, sizeof(i)));
+    }
+    u32 false_positives = 0;
+    for (u32 i = 0; i < count; i += 2) {
+        false_positives += dlb_cuckoo_contains(&filter, &i, sizeof(i));
+    }
+    DLB_ASSERT(false_positives < count / 2 / 10);
+
+    // Fill until full, every accepted key must still be found
+    u32 added = count;
+    while (dlb_cuckoo_insert(&filter, &added, sizeof(added))) {
+        added++;
+    }
+    DLB_ASSERT(dlb_cuckoo_load_factor(&filter) > 0.9f);
+    for (u32 i = count; i < added; i++) {
+        DLB_ASSERT(dlb_cuckoo_contains(&filter, &i, sizeof(i)));
+    }
+    dlb_cuckoo_free(&filter);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
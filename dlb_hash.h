@@ -7,37 +7,206 @@
 //-- header --------------------------------------------------------------------
 #include "dlb_types.h"
 #include "dlb_murmur3.h"
+#include "dlb_arena.h"
 #include <stdio.h>
 
+// Define DLB_HASH_NO_SIMD to force the scalar group fallback
+#if !defined(DLB_HASH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define DLB_HASH__SSE2 1
+#include <emmintrin.h>
+#endif
+
 typedef enum
 {
     DLB_HASH_STRING,
     DLB_HASH_INT
 } dlb_hash_type;
 
+typedef enum
+{
+    // Linear probing where an insert takes the slot of any entry that is
+    // closer to its home than the new key is ("steal from the rich"), and
+    // delete shifts the following entries back instead of leaving a
+    // tombstone. Probe lengths stay short and even, misses stop as soon as
+    // they pass an entry closer to home, and heavy insert/delete churn never
+    // degrades lookups.
+    DLB_HASH_ROBIN_HOOD = 0x1,
+    // DLB_HASH_STRING keys are copied on insert, so callers don't have to
+    // keep them alive. Keys up to DLB_HASH_INLINE_KEY bytes are stored in the
+    // entry itself, longer keys in an arena owned by the table.
+    DLB_HASH_OWNED_KEYS = 0x2,
+    // Grow without stopping the world: the old buckets are kept alongside the
+    // new ones and every insert, search and delete migrates up to
+    // DLB_HASH_REHASH_STEP old slots, or call dlb_hash_rehash_step when idle.
+    // Keys are looked up in both until migration finishes. Every operation
+    // is O(DLB_HASH_REHASH_STEP) on top of its own probe; the one that starts
+    // a migration only adds two dlb_calloc calls, whose pages the OS zeroes
+    // lazily as later operations first touch them.
+    DLB_HASH_INCREMENTAL = 0x4,
+    // Set by dlb_hash_freeze, not by callers. Insert and delete are errors,
+    // and search, search_int and search_batch never write to the table (no
+    // migration, no DLB_HASH_STATS counting), so any number of threads can
+    // search it without locks.
+    DLB_HASH_FROZEN = 0x8
+} dlb_hash_flags;
+
+#define DLB_HASH_INLINE_KEY 16
+// Old slots migrated per operation in DLB_HASH_INCREMENTAL mode. Must be
+// >= 2 so migration finishes before the doubled table fills up.
+#define DLB_HASH_REHASH_STEP 16
+
 typedef struct
 {
-    const void *key;
-    size_t klen;
+    union {
+        const void *key;
+        // DLB_HASH_OWNED_KEYS and klen <= DLB_HASH_INLINE_KEY, see
+        // dlb_hash_entry_key()
+        char key_inline[DLB_HASH_INLINE_KEY];
+    };
     void *value;
+    u32 klen;
+    // Full hash of key. Checked before comparing keys so mismatches rarely
+    // dereference the caller's key memory, and reused when rehashing.
+    u32 hash;
 } dlb_hash_entry;
 
+// Define DLB_HASH_STATS (the same way in every translation unit, it changes
+// the size of dlb_hash) to count probe lengths and key compares, see
+// dlb_hash_stats(). Costs an increment or two per operation.
+#define DLB_HASH_STATS_BUCKETS 16
+
 typedef struct
+{
+    // [i] = # of lookups that probed i + 1 groups (slots in Robin Hood mode),
+    // the last bucket counts everything longer
+    u64 hit_probes[DLB_HASH_STATS_BUCKETS];
+    u64 miss_probes[DLB_HASH_STATS_BUCKETS];
+    u64 key_compares;  // strncmp calls, i.e. h2 and full hash both matched
+} dlb_hash_counters;
+
+typedef struct dlb_hash
 {
     dlb_hash_type type;
     const char *name;
     size_t size;
     dlb_hash_entry *buckets;
     FILE *debug;
+    size_t count;       // # of live entries, including any still in old
+    size_t tombstones;  // # of DLB_HASH_CTRL_DELETED slots
+    // Optional: if non-zero, keys are never placed more than max_probes groups
+    // (slots in Robin Hood mode) from home; the table grows instead. Bounds
+    // search cost on misses. Too small a bound makes the table grow without
+    // limit, e.g. Robin Hood mode needs ~16+.
+    u32 max_probes;
+    u32 flags;  // dlb_hash_flags, set before dlb_hash_init
+    dlb_arena keys;  // DLB_HASH_OWNED_KEYS storage for keys too long to inline
+    // One control byte per slot, see below. Followed by a copy of the first
+    // DLB_HASH_GROUP - 1 bytes so a group load starting near the end doesn't
+    // have to wrap around.
+    u8 *ctrl;
+    // DLB_HASH_INCREMENTAL: buckets being migrated out of, NULL when no
+    // migration is in progress. Its slots before migrate_pos are all free.
+    struct dlb_hash *old;
+    size_t migrate_pos;
+#ifdef DLB_HASH_STATS
+    dlb_hash_counters counters;
+#endif
 } dlb_hash;
 
+typedef struct
+{
+    size_t size;
+    size_t count;
+    size_t tombstones;
+    float load_factor;        // (count + tombstones) / size
+    // Farthest any entry sits from home, in groups (slots in Robin Hood mode)
+    size_t max_displacement;
+    // Zero unless DLB_HASH_STATS is defined. Lookups include the ones done
+    // by insert and delete.
+    dlb_hash_counters counters;
+} dlb_hash_statistics;
+
+// Control bytes. Full slots store h2, the top 7 bits of the hash with the
+// high bit set, so a probe can compare DLB_HASH_GROUP slots at once and only
+// touch entries whose h2 matches. Empty and deleted have the high bit clear.
+// Empty is 0 so fresh control bytes come from dlb_calloc, whose large
+// allocations are lazily zeroed pages: starting a (incremental) rehash
+// doesn't have to write the whole array up front.
+#define DLB_HASH_GROUP 16
+#define DLB_HASH_CTRL_EMPTY ((u8)0x00)
+#define DLB_HASH_CTRL_DELETED ((u8)0x01)
+
+// Where the key bytes of a full entry live
+static inline const void *dlb_hash_entry_key(const dlb_hash *table, const dlb_hash_entry *entry)
+{
+    if ((table->flags & DLB_HASH_OWNED_KEYS) && table->type == DLB_HASH_STRING &&
+        entry->klen <= DLB_HASH_INLINE_KEY) {
+        return entry->key_inline;
+    }
+    return entry->key;
+}
+
+// Integer keys: xor-shift, multiply, xor-shift. One multiply instead of
+// fmix64's two; the final shift folds the well-mixed high product bits into
+// the low 32 that become the hash.
+static inline u32 _dlb_hash_hash_int(u64 key)
+{
+    key ^= key >> 32;
+    key *= 0xd6e8feb86659fd93ULL;
+    key ^= key >> 32;
+    return (u32)key;
+}
+
+static inline u8 _dlb_hash_h2(u32 hash)
+{
+    return (u8)(hash >> 25) | 0x80;
+}
+
+static inline int _dlb_hash_ctrl_full(u8 c)
+{
+    return c >> 7;
+}
+
+// Bitmask of the slots in the group starting at ctrl whose control byte is c
+static inline u32 _dlb_hash_group_match(const u8 *ctrl, u8 c)
+{
+#if DLB_HASH__SSE2
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)c)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < DLB_HASH_GROUP; i++) {
+        mask |= (u32)(ctrl[i] == c) << i;
+    }
+    return mask;
+#endif
+}
+
+// Bitmask of the slots in the group starting at ctrl that are empty or deleted
+static inline u32 _dlb_hash_group_match_free(const u8 *ctrl)
+{
+#if DLB_HASH__SSE2
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl)) ^ 0xFFFF;
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < DLB_HASH_GROUP; i++) {
+        mask |= (u32)!_dlb_hash_ctrl_full(ctrl[i]) << i;
+    }
+    return mask;
+#endif
+}
+
 #if DEBUG
 // NOTE: For easier casting in debugger, make strings readable. Could use union instead, but wutevs for now.
 typedef struct
 {
-    const char *key;
-    size_t klen;
+    union {
+        const char *key;
+        char key_inline[DLB_HASH_INLINE_KEY];
+    };
     void *value;
+    u32 klen;
+    u32 hash;
 } dlb_hash_entry_str;
 
 typedef struct
@@ -47,15 +216,56 @@ typedef struct
     size_t size;
     dlb_hash_entry_str *buckets;
     FILE *debug;
+    size_t count;
+    size_t tombstones;
+    u32 max_probes;
+    u32 flags;
+    dlb_arena keys;
+    u8 *ctrl;
+    struct dlb_hash *old;
+    size_t migrate_pos;
+#ifdef DLB_HASH_STATS
+    dlb_hash_counters counters;
+#endif
 } dlb_hash_str;
 #endif
 
+// size_pow2 is rounded up to at least DLB_HASH_GROUP
 void dlb_hash_init(dlb_hash *table, dlb_hash_type type, const char *name,
     size_t size_pow2);
 void dlb_hash_free(dlb_hash *table);
 void dlb_hash_insert(dlb_hash *table, const void *key, size_t klen, void *value);
 void *dlb_hash_search(dlb_hash *table, const void *key, size_t klen, int *found);
+// Look up n keys at once, overlapping their cache misses. out_values[i] gets
+// the value of keys[i], or NULL if not found. Returns the # of keys found.
+size_t dlb_hash_search_batch(dlb_hash *table, const void **keys, const size_t *klens, void **out_values,
+    size_t n);
 void dlb_hash_delete(dlb_hash *table, const void *key, size_t klen);
+// DLB_HASH_INT fast path: the key is the integer itself, hashed with a
+// one-multiply mixer and compared as an integer. Any value is a valid key,
+// including 0. Must fit in a pointer.
+void dlb_hash_insert_int(dlb_hash *table, u64 key, void *value);
+void *dlb_hash_search_int(dlb_hash *table, u64 key, int *found);
+void dlb_hash_delete_int(dlb_hash *table, u64 key);
+
+// Snapshot of table's shape and counters. O(size): walks every slot to find
+// the max displacement.
+void dlb_hash_stats(dlb_hash *table, dlb_hash_statistics *stats);
+// Zero the DLB_HASH_STATS counters
+void dlb_hash_stats_reset(dlb_hash *table);
+// Rebuild buckets at size_pow2 (>= count), dropping tombstones. Insert does
+// this automatically when the table gets too full. Finishes any incremental
+// migration first.
+void dlb_hash_rehash(dlb_hash *table, size_t size_pow2);
+// DLB_HASH_INCREMENTAL: migrate up to budget old slots. Returns 1 if there's
+// still migration left to do, 0 when done (or none was in progress).
+int dlb_hash_rehash_step(dlb_hash *table, size_t budget);
+// Drop tombstones without changing the size
+void dlb_hash_purge(dlb_hash *table);
+// Compact table into a read-only snapshot, see DLB_HASH_FROZEN: finishes any
+// migration, drops tombstones and rebuilds at size_pow2, or at the smallest
+// size that keeps the load <= 75% if 0. Free it with dlb_hash_free as usual.
+void dlb_hash_freeze(dlb_hash *table, size_t size_pow2);
 
 void dlb_hash_test();
 
@@ -76,22 +286,71 @@ void dlb_hash_test();
 #include <string.h>
 #include <stdio.h>
 
-const void *_DLB_HASH_FREED = (void *)INT32_MIN;
+// Returned by _dlb_hash_find when there is no such slot
+#define _DLB_HASH_NONE SIZE_MAX
+// # of keys dlb_hash_search_batch keeps in flight
+#define _DLB_HASH_BATCH 16
+
+#ifdef DLB_HASH_STATS
+#define _dlb_hash_stat(x) (x)
+#else
+#define _dlb_hash_stat(x) ((void)0)
+#endif
+
+// Count x for a lookup in table. Frozen tables are searched by many threads
+// at once, so their lookups aren't counted.
+#define _dlb_hash_stat_lookup(table, x) _dlb_hash_stat(((table)->flags & DLB_HASH_FROZEN) ? (void)0 : (void)(x))
+
+// Record a lookup that probed `probes` groups/slots
+#define _dlb_hash_stat_probes(table, hist, probes) \
+    _dlb_hash_stat_lookup(table, (table)->counters.hist[MIN((size_t)(probes), DLB_HASH_STATS_BUCKETS) - 1]++)
+
+static inline void _dlb_hash_counters_add(dlb_hash_counters *dst, const dlb_hash_counters *src)
+{
+    for (u32 i = 0; i < DLB_HASH_STATS_BUCKETS; i++) {
+        dst->hit_probes[i] += src->hit_probes[i];
+        dst->miss_probes[i] += src->miss_probes[i];
+    }
+    dst->key_compares += src->key_compares;
+}
+
+#if DLB_HASH__SSE2
+#define _dlb_hash_prefetch(p) _mm_prefetch((const char *)(p), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+#define _dlb_hash_prefetch(p) __builtin_prefetch(p)
+#else
+#define _dlb_hash_prefetch(p) (void)(p)
+#endif
 
 static size_t _dlb_hash_pow2(size_t x)
 {
     return (x & (x - 1)) == 0;
 }
 
+static void _dlb_hash_alloc(dlb_hash *table, size_t size)
+{
+    table->size = size;
+    table->buckets = (dlb_hash_entry *)dlb_calloc(table->size,
+        sizeof(table->buckets[0]));
+    // All DLB_HASH_CTRL_EMPTY
+    table->ctrl = (u8 *)dlb_calloc(table->size + DLB_HASH_GROUP - 1, 1);
+}
+
 void dlb_hash_init(dlb_hash *table, dlb_hash_type type, const char *name,
     size_t size_pow2)
 {
-    DLB_ASSERT(_dlb_hash_pow2(size_pow2));
+    DLB_ASSERT(size_pow2 && _dlb_hash_pow2(size_pow2));
     table->type = type;
     table->name = name;
-    table->size = size_pow2;
-    table->buckets = (dlb_hash_entry *)dlb_calloc(table->size,
-        sizeof(table->buckets[0]));
+    table->count = 0;
+    table->tombstones = 0;
+    table->old = 0;
+    table->migrate_pos = 0;
+    dlb_hash_stats_reset(table);
+    _dlb_hash_alloc(table, MAX(size_pow2, DLB_HASH_GROUP));
+    dlb_memset(&table->keys, 0, sizeof(table->keys));
+    // Big slabs, owned keys are usually small and numerous
+    table->keys.block_size = 64 * 1024;
 #if _DEBUG
     if (table->debug) {
         fprintf(table->debug, "[hash][init] %s\n", table->name);
@@ -106,11 +365,18 @@ void dlb_hash_free(dlb_hash *table)
         fprintf(table->debug, "[hash][free] %s\n", table->name);
     }
 #endif
+    if (table->old) {
+        dlb_free(table->old->buckets);
+        dlb_free(table->old->ctrl);
+        dlb_free(table->old);
+        table->old = 0;
+    }
     dlb_free(table->buckets);
+    dlb_free(table->ctrl);
+    dlb_arena_free(&table->keys);
 }
 
-static dlb_hash_entry *_dlb_hash_find(dlb_hash *table, const void *key, size_t klen, dlb_hash_entry **first_freed,
-    u8 return_first)
+static u32 _dlb_hash_hash(dlb_hash *table, const void *key, size_t klen)
 {
     u32 hash = 0;
     switch (table->type) {
@@ -118,87 +384,531 @@ static dlb_hash_entry *_dlb_hash_find(dlb_hash *table, const void *key, size_t k
             hash = dlb_murmur3(key, klen);
             break;
         case DLB_HASH_INT:
-            hash = dlb_murmur3(&key, klen);
+            hash = _dlb_hash_hash_int((u64)(uintptr_t)key);
             break;
         default: DLB_ASSERT(0);
     }
-    u32 index = hash & (table->size - 1);
-    u32 i = 0;
+    return hash;
+}
+
+// DLB_HASH_INT keys are the pointer value itself, klen is ignored
+static int _dlb_hash_key_equal(dlb_hash *table, const dlb_hash_entry *entry, const void *key, size_t klen,
+    u32 hash)
+{
+    if (entry->hash != hash) {
+        return 0;
+    }
+    switch (table->type) {
+        case DLB_HASH_STRING:
+            if (entry->klen != klen) {
+                return 0;
+            }
+            _dlb_hash_stat_lookup(table, table->counters.key_compares++);
+            return !strncmp((const char *)dlb_hash_entry_key(table, entry), (const char *)key, klen);
+        case DLB_HASH_INT: return entry->key == key;
+        default: DLB_ASSERT(0); return 0;
+    }
+}
+
+// Fill a new entry, copying the key if the table owns its keys
+static void _dlb_hash_entry_init(dlb_hash *table, dlb_hash_entry *entry, const void *key, size_t klen, void *value,
+    u32 hash)
+{
+    DLB_ASSERT(klen <= UINT32_MAX);
+    if ((table->flags & DLB_HASH_OWNED_KEYS) && table->type == DLB_HASH_STRING) {
+        char *copy = klen <= DLB_HASH_INLINE_KEY ? entry->key_inline : (char *)dlb_arena_alloc(&table->keys, klen);
+        memcpy(copy, key, klen);
+        if (klen > DLB_HASH_INLINE_KEY) {
+            entry->key = copy;
+        }
+    } else {
+        entry->key = key;
+    }
+    entry->klen = (u32)klen;
+    entry->value = value;
+    entry->hash = hash;
+}
+
+// Overwrite an existing entry's value
+static void _dlb_hash_entry_update(dlb_hash *table, dlb_hash_entry *entry, const void *key, void *value)
+{
+    if (!(table->flags & DLB_HASH_OWNED_KEYS)) {
+        entry->key = key;
+    }
+    entry->value = value;
+}
+
+static void _dlb_hash_set_ctrl(dlb_hash *table, size_t index, u8 c)
+{
+    table->ctrl[index] = c;
+    if (index < DLB_HASH_GROUP - 1) {
+        table->ctrl[table->size + index] = c;
+    }
+}
+
+// Max # of groups (slots in Robin Hood mode) a probe sequence may visit
+static size_t _dlb_hash_probe_limit(dlb_hash *table)
+{
+    size_t steps = table->size;
+    if (!(table->flags & DLB_HASH_ROBIN_HOOD)) {
+        steps /= DLB_HASH_GROUP;
+    }
+    return table->max_probes ? MIN(table->max_probes, steps) : steps;
+}
+
+//-- Robin Hood mode -----------------------------------------------------------
+// Slots are probed linearly. The control bytes still hold h2 so mismatches
+// are rejected without loading the entry's key, but DELETED is never used.
+
+// Distance of the entry in a full slot from its home slot
+static size_t _dlb_hash_rh_dist(dlb_hash *table, size_t index)
+{
+    size_t mask = table->size - 1;
+    return (index - (table->buckets[index].hash & mask)) & mask;
+}
+
+static size_t _dlb_hash_rh_find(dlb_hash *table, const void *key, size_t klen, u32 hash)
+{
+    size_t mask = table->size - 1;
+    size_t index = hash & mask;
+    u8 h2 = _dlb_hash_h2(hash);
+    size_t limit = _dlb_hash_probe_limit(table);
+    size_t dist = 0;
+    for (; dist < limit; dist++) {
+        u8 c = table->ctrl[index];
+        // Key would have displaced this entry if it were in the table
+        if (c == DLB_HASH_CTRL_EMPTY || _dlb_hash_rh_dist(table, index) < dist) {
+            break;
+        }
+        if (c == h2 && _dlb_hash_key_equal(table, &table->buckets[index], key, klen, hash)) {
+            _dlb_hash_stat_probes(table, hit_probes, dist + 1);
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    _dlb_hash_stat_probes(table, miss_probes, MIN(dist + 1, MAX(limit, 1)));
+    return _DLB_HASH_NONE;
+}
+
+// Place an entry known not to be in the table. Returns 0 if some entry would
+// end up max_probes or more slots from home; *carry then holds the entry that
+// still needs a slot (not necessarily the one passed in), and the table holds
+// all the others.
+static int _dlb_hash_rh_place(dlb_hash *table, dlb_hash_entry *carry)
+{
+    size_t mask = table->size - 1;
+    size_t index = carry->hash & mask;
+    size_t limit = _dlb_hash_probe_limit(table);
+    for (size_t dist = 0; dist < limit; dist++) {
+        if (table->ctrl[index] == DLB_HASH_CTRL_EMPTY) {
+            _dlb_hash_set_ctrl(table, index, _dlb_hash_h2(carry->hash));
+            table->buckets[index] = *carry;
+            return 1;
+        }
+        size_t existing = _dlb_hash_rh_dist(table, index);
+        if (existing < dist) {
+            dlb_hash_entry evicted = table->buckets[index];
+            table->buckets[index] = *carry;
+            _dlb_hash_set_ctrl(table, index, _dlb_hash_h2(carry->hash));
+            *carry = evicted;
+            dist = existing;
+        }
+        index = (index + 1) & mask;
+    }
+    return 0;
+}
+
+// Backward-shift delete: pull each following entry one slot closer to home
+// until reaching an empty slot or an entry that's already home
+static void _dlb_hash_rh_erase(dlb_hash *table, size_t index)
+{
+    size_t mask = table->size - 1;
+    for (;;) {
+        size_t next = (index + 1) & mask;
+        if (table->ctrl[next] == DLB_HASH_CTRL_EMPTY || _dlb_hash_rh_dist(table, next) == 0) {
+            break;
+        }
+        table->buckets[index] = table->buckets[next];
+        _dlb_hash_set_ctrl(table, index, table->ctrl[next]);
+        index = next;
+    }
+    _dlb_hash_set_ctrl(table, index, DLB_HASH_CTRL_EMPTY);
+    table->buckets[index].key = 0;
+    table->buckets[index].klen = 0;
+    table->buckets[index].value = 0;
+    table->count--;
+}
+
+//------------------------------------------------------------------------------
+
+// Returns the index of the slot holding key, or _DLB_HASH_NONE. If free_slot
+// is given, it receives the first empty or deleted slot on the probe sequence
+// (or _DLB_HASH_NONE if the probe limit was reached first).
+//
+// Groups are probed at home + GROUP * T(i), where T(i) = i(i+1)/2 is the i-th
+// triangular number, i.e. step by 1, 2, 3, ... groups. In a power-of-two
+// table this visits every group start exactly once. Groups start anywhere,
+// not just on multiples of DLB_HASH_GROUP; the mirrored ctrl tail makes that
+// work at the end of the table.
+static size_t _dlb_hash_find(dlb_hash *table, const void *key, size_t klen, u32 hash, size_t *free_slot)
+{
+    if (table->flags & DLB_HASH_ROBIN_HOOD) {
+        DLB_ASSERT(!free_slot);
+        return _dlb_hash_rh_find(table, key, klen, hash);
+    }
+
+    size_t mask = table->size - 1;
+    size_t pos = hash & mask;
+    u8 h2 = _dlb_hash_h2(hash);
+    size_t limit = _dlb_hash_probe_limit(table);
 
 #if _DEBUG
     if (table->debug) {
-        fprintf(table->debug, "[hash][find] finding slot for %.*s, hash %u, starting at %u\n", (int)klen, (char *)key,
-            hash, index);
+        fprintf(table->debug, "[hash][find] finding slot for %.*s, hash %u, starting at %zu\n", (int)klen,
+            (char *)key, hash, pos);
     }
 #endif
 
-    dlb_hash_entry *entry = 0;
-    for (;;) {
-        entry = table->buckets + index;
-
-        // Empty slot
-        if (!entry->klen) {
-            if (entry->key == _DLB_HASH_FREED) {
-                if (return_first) {
-                    break;
-                } else if (first_freed && !*first_freed) {
-                    *first_freed = entry;
-                }
+    if (free_slot) {
+        *free_slot = _DLB_HASH_NONE;
+    }
+    size_t i = 0;
+    for (; i < limit; i++) {
+        const u8 *group = table->ctrl + pos;
+        for (u32 match = _dlb_hash_group_match(group, h2); match; match &= match - 1) {
+            size_t index = (pos + dlb_ctz64(match)) & mask;
+            if (_dlb_hash_key_equal(table, &table->buckets[index], key, klen, hash)) {
 #if _DEBUG
                 if (table->debug) {
-                    fprintf(table->debug, "[hash][find] %u is empty (FREED)\n", index);
+                    fprintf(table->debug, "[hash][find] found slot at %zu\n", index);
                 }
 #endif
-            } else {
+                _dlb_hash_stat_probes(table, hit_probes, i + 1);
+                return index;
+            }
+        }
+        if (free_slot && *free_slot == _DLB_HASH_NONE) {
+            u32 free = _dlb_hash_group_match_free(group);
+            if (free) {
+                *free_slot = (pos + dlb_ctz64(free)) & mask;
+            }
+        }
+        // An empty slot means the key was never pushed past this group
+        if (_dlb_hash_group_match(group, DLB_HASH_CTRL_EMPTY)) {
+            i++;
+            break;
+        }
+        pos = (pos + (i + 1) * DLB_HASH_GROUP) & mask;
+    }
+    _dlb_hash_stat_probes(table, miss_probes, MAX(i, 1));
+
 #if _DEBUG
-                if (table->debug && !return_first) {
-                    fprintf(table->debug, "[hash][find] %u is empty\n", index);
-                }
+    if (table->debug) {
+        fprintf(table->debug, "[hash][find] not found\n");
+    }
 #endif
-                break;
+    return _DLB_HASH_NONE;
+}
+
+// Place a key known not to be in the table into the first free slot of its
+// probe sequence, without checking the load factor. Used while rehashing and
+// migrating.
+static int _dlb_hash_place(dlb_hash *table, const dlb_hash_entry *src)
+{
+    if (table->flags & DLB_HASH_ROBIN_HOOD) {
+        dlb_hash_entry carry = *src;
+        return _dlb_hash_rh_place(table, &carry);
+    }
+
+    u32 hash = src->hash;
+    size_t mask = table->size - 1;
+    size_t pos = hash & mask;
+    size_t limit = _dlb_hash_probe_limit(table);
+    for (size_t i = 0; i < limit; i++) {
+        u32 free = _dlb_hash_group_match_free(table->ctrl + pos);
+        if (free) {
+            size_t index = (pos + dlb_ctz64(free)) & mask;
+            if (table->ctrl[index] == DLB_HASH_CTRL_DELETED) {
+                table->tombstones--;
             }
+            _dlb_hash_set_ctrl(table, index, _dlb_hash_h2(hash));
+            table->buckets[index] = *src;
+            return 1;
         }
+        pos = (pos + (i + 1) * DLB_HASH_GROUP) & mask;
+    }
+    return 0;
+}
 
-        // Match
-        int match = 0;
-        if (entry->klen == klen) {
-            switch (table->type) {
-                case DLB_HASH_STRING: {
-                    match = !strncmp((const char *)entry->key, (const char *)key, klen);
-                    break;
-                } case DLB_HASH_INT: {
-                    match = entry->key == key;
-                    break;
-                } default: {
-                    DLB_ASSERT(0);
-                }
+// Rebuild the current buckets at size_pow2, leaving table->old alone.
+// pending, if any, is an entry being placed that isn't in the buckets; its
+// key is moved along with the others when the arena is compacted.
+static void _dlb_hash_rebuild(dlb_hash *table, size_t size_pow2, dlb_hash_entry *pending)
+{
+    size_pow2 = MAX(size_pow2, DLB_HASH_GROUP);
+
+#if _DEBUG
+    if (table->debug) {
+        fprintf(table->debug, "[hash][rehash] %s %zu -> %zu (%zu live, %zu deleted)\n", table->name, table->size,
+            size_pow2, table->count, table->tombstones);
+    }
+#endif
+
+    dlb_hash_entry *old_buckets = table->buckets;
+    u8 *old_ctrl = table->ctrl;
+    size_t old_size = table->size;
+    for (;;) {
+        _dlb_hash_alloc(table, size_pow2);
+        size_t i = 0;
+        for (; i < old_size; i++) {
+            if (_dlb_hash_ctrl_full(old_ctrl[i]) && !_dlb_hash_place(table, &old_buckets[i])) {
+                break;
             }
         }
-        if (match) {
+        if (i == old_size) {
             break;
         }
+        // Couldn't keep every key within max_probes, try a bigger table
+        dlb_free(table->buckets);
+        dlb_free(table->ctrl);
+        size_pow2 <<= 1;
+    }
+    dlb_free(old_buckets);
+    dlb_free(old_ctrl);
+    table->tombstones = 0;
 
-        // Next slot
-        i++;
-        index += (i * (i + 1)) >> 1;  // Same as (0.5f)i + (0.5f)i^2
-        index &= (table->size - 1);
-
-        // NOTE(perf): This check will check entire hash table if power-of-two
-        //             size. This would be a good place to enforce max probes.
-        // End of probe; not found
-        if (i == table->size) {
-            entry = 0;
+    // Copy arena keys into a fresh arena, drops the bytes of deleted keys and
+    // lays the rest out in slot order. Not while old entries still point into
+    // the arena.
+    if ((table->flags & DLB_HASH_OWNED_KEYS) && table->type == DLB_HASH_STRING && !table->old) {
+        dlb_arena old_keys = table->keys;
+        dlb_memset(&table->keys, 0, sizeof(table->keys));
+        table->keys.block_size = old_keys.block_size;
+        for (size_t i = 0; i < table->size; i++) {
+            dlb_hash_entry *entry = &table->buckets[i];
+            if (_dlb_hash_ctrl_full(table->ctrl[i]) && entry->klen > DLB_HASH_INLINE_KEY) {
+                void *copy = dlb_arena_alloc(&table->keys, entry->klen);
+                memcpy(copy, entry->key, entry->klen);
+                entry->key = copy;
+            }
+        }
+        if (pending && pending->klen > DLB_HASH_INLINE_KEY) {
+            void *copy = dlb_arena_alloc(&table->keys, pending->klen);
+            memcpy(copy, pending->key, pending->klen);
+            pending->key = copy;
+        }
+        dlb_arena_free(&old_keys);
+    }
+}
+
+//-- Incremental mode ----------------------------------------------------------
+
+static void _dlb_hash_erase(dlb_hash *table, size_t index);
+
+// Place an entry known not to be in the table, growing (stop-the-world) in
+// the rare case max_probes can't be met
+static void _dlb_hash_place_grow(dlb_hash *table, const dlb_hash_entry *src)
+{
+    dlb_hash_entry carry = *src;
+    for (;;) {
+        int placed = (table->flags & DLB_HASH_ROBIN_HOOD) ? _dlb_hash_rh_place(table, &carry)
+                                                           : _dlb_hash_place(table, &carry);
+        if (placed) {
             break;
         }
+        _dlb_hash_rebuild(table, table->size << 1, &carry);
+    }
+}
+
+int dlb_hash_rehash_step(dlb_hash *table, size_t budget)
+{
+    dlb_hash *old = table->old;
+    if (!old) {
+        return 0;
+    }
+    while (budget && table->migrate_pos < old->size) {
+        size_t pos = table->migrate_pos;
+        budget--;
+        if (!_dlb_hash_ctrl_full(old->ctrl[pos])) {
+            table->migrate_pos++;
+            continue;
+        }
+        dlb_hash_entry entry = old->buckets[pos];
+        // Robin Hood erase may shift the next entry into pos, it's looked
+        // at again on the next iteration
+        if (old->flags & DLB_HASH_ROBIN_HOOD) {
+            _dlb_hash_rh_erase(old, pos);
+        } else {
+            _dlb_hash_erase(old, pos);
+        }
+        _dlb_hash_place_grow(table, &entry);
     }
+    if (table->migrate_pos < old->size) {
+        return 1;
+    }
+
+#if _DEBUG
+    if (table->debug) {
+        fprintf(table->debug, "[hash][rehash_step] %s migration to %zu done\n", table->name, table->size);
+    }
+#endif
+    DLB_ASSERT(old->count == 0);
+    // Lookups in old count towards table from now on
+    _dlb_hash_stat(_dlb_hash_counters_add(&table->counters, &old->counters));
+    dlb_free(old->buckets);
+    dlb_free(old->ctrl);
+    dlb_free(old);
+    table->old = 0;
+    table->migrate_pos = 0;
+    return 0;
+}
+
+// Move the current buckets to table->old and start over with empty buckets
+// at size_pow2
+static void _dlb_hash_start_migration(dlb_hash *table, size_t size_pow2)
+{
+    DLB_ASSERT(!table->old);
 
 #if _DEBUG
     if (table->debug) {
-        fprintf(table->debug, "[hash][find] found slot at %u\n", index);
+        fprintf(table->debug, "[hash][rehash] %s %zu -> %zu incrementally (%zu live, %zu deleted)\n", table->name,
+            table->size, size_pow2, table->count, table->tombstones);
     }
 #endif
 
-    return entry;
+    dlb_hash *old = (dlb_hash *)dlb_malloc(sizeof(*old));
+    *old = *table;
+    old->debug = 0;
+    old->old = 0;
+    // Keys stay in table->keys, old must never free or compact them
+    dlb_memset(&old->keys, 0, sizeof(old->keys));
+    dlb_hash_stats_reset(old);
+    table->old = old;
+    table->migrate_pos = 0;
+    table->tombstones = 0;
+    _dlb_hash_alloc(table, size_pow2);
+}
+
+//------------------------------------------------------------------------------
+
+void dlb_hash_rehash(dlb_hash *table, size_t size_pow2)
+{
+    DLB_ASSERT(!(table->flags & DLB_HASH_FROZEN));
+    DLB_ASSERT(size_pow2 && _dlb_hash_pow2(size_pow2));
+    DLB_ASSERT(size_pow2 >= table->count);
+    dlb_hash_rehash_step(table, SIZE_MAX);
+    _dlb_hash_rebuild(table, size_pow2, 0);
+}
+
+void dlb_hash_purge(dlb_hash *table)
+{
+    dlb_hash_rehash(table, table->size);
+}
+
+void dlb_hash_freeze(dlb_hash *table, size_t size_pow2)
+{
+    if (!size_pow2) {
+        size_pow2 = DLB_HASH_GROUP;
+        while (table->count * 4 > size_pow2 * 3) {
+            size_pow2 <<= 1;
+        }
+    }
+    dlb_hash_rehash(table, size_pow2);
+    table->flags |= DLB_HASH_FROZEN;
+}
+
+// Make room for one more entry. Doubles if live entries would pass 50% load
+// or a probe ran into max_probes, otherwise the table is mostly tombstones
+// and rehashing in place frees them. pending is passed to _dlb_hash_rebuild.
+static void _dlb_hash_grow(dlb_hash *table, int probe_limit_hit, dlb_hash_entry *pending)
+{
+    if (table->flags & DLB_HASH_INCREMENTAL) {
+        // Only happens mid-migration if inserts outpaced DLB_HASH_REHASH_STEP
+        // or max_probes was hit
+        dlb_hash_rehash_step(table, SIZE_MAX);
+    }
+    size_t size = table->size;
+    if (probe_limit_hit || (table->count + 1) * 2 > size) {
+        size <<= 1;
+    }
+    if (table->flags & DLB_HASH_INCREMENTAL) {
+        _dlb_hash_start_migration(table, size);
+    } else {
+        _dlb_hash_rebuild(table, size, pending);
+    }
+}
+
+// Live entries in the current buckets, i.e. not counting those still in old
+static size_t _dlb_hash_current_count(dlb_hash *table)
+{
+    return table->count - (table->old ? table->old->count : 0);
+}
+
+// Find key in the old buckets of an incremental migration
+static size_t _dlb_hash_find_old(dlb_hash *table, const void *key, size_t klen, u32 hash)
+{
+    return table->old ? _dlb_hash_find(table->old, key, klen, hash, 0) : _DLB_HASH_NONE;
+}
+
+static void _dlb_hash_insert(dlb_hash *table, const void *key, size_t klen, u32 hash, void *value)
+{
+    DLB_ASSERT(!(table->flags & DLB_HASH_FROZEN));  // Error: Frozen tables are read-only
+    if (table->old) {
+        dlb_hash_rehash_step(table, DLB_HASH_REHASH_STEP);
+        size_t index = _dlb_hash_find_old(table, key, klen, hash);
+        if (index != _DLB_HASH_NONE) {
+            _dlb_hash_entry_update(table, &table->old->buckets[index], key, value);
+            return;
+        }
+    }
+
+    if (table->flags & DLB_HASH_ROBIN_HOOD) {
+        size_t index = _dlb_hash_rh_find(table, key, klen, hash);
+        if (index != _DLB_HASH_NONE) {
+            _dlb_hash_entry_update(table, &table->buckets[index], key, value);
+            return;
+        }
+        if ((_dlb_hash_current_count(table) + 1) * 4 > table->size * 3) {
+            _dlb_hash_grow(table, 0, 0);
+        }
+        dlb_hash_entry carry;
+        _dlb_hash_entry_init(table, &carry, key, klen, value, hash);
+        while (!_dlb_hash_rh_place(table, &carry)) {
+            _dlb_hash_grow(table, 1, &carry);
+        }
+        table->count++;
+        return;
+    }
+
+    for (;;) {
+        size_t free_slot = 0;
+        size_t index = _dlb_hash_find(table, key, klen, hash, &free_slot);
+
+        if (index != _DLB_HASH_NONE) {
+            _dlb_hash_entry_update(table, &table->buckets[index], key, value);
+            return;
+        }
+
+        if (free_slot == _DLB_HASH_NONE) {
+            // Probe limit hit
+            _dlb_hash_grow(table, 1, 0);
+            continue;
+        }
+        int reuse = table->ctrl[free_slot] == DLB_HASH_CTRL_DELETED;
+        if (!reuse && (_dlb_hash_current_count(table) + table->tombstones + 1) * 4 > table->size * 3) {
+            // Load factor > 75%
+            _dlb_hash_grow(table, 0, 0);
+            continue;
+        }
+
+        if (reuse) {
+            table->tombstones--;
+        }
+        _dlb_hash_set_ctrl(table, free_slot, _dlb_hash_h2(hash));
+        _dlb_hash_entry_init(table, &table->buckets[free_slot], key, klen, value, hash);
+        table->count++;
+        return;
+    }
 }
 
 void dlb_hash_insert(dlb_hash *table, const void *key, size_t klen, void *value)
@@ -212,21 +922,27 @@ void dlb_hash_insert(dlb_hash *table, const void *key, size_t klen, void *value)
     }
 #endif
 
-    dlb_hash_entry *first_freed = 0;
-    dlb_hash_entry *entry =
-        _dlb_hash_find(table, key, klen, &first_freed, 1);
+    _dlb_hash_insert(table, key, klen, _dlb_hash_hash(table, key, klen), value);
+}
 
-    if (entry) {
-        entry->key = key;
-        entry->klen = klen;
-        entry->value = value;
-    } else {
-        // Out of memory
-        // NOTE: In the power-of-two, triangle number case this won't happen
-        //       until table is 100% full. We should realloc much sooner.
-        DLB_ASSERT(!"DLB_HASH: Out of memory");  // TODO: Realloc hash table
+static void *_dlb_hash_search(dlb_hash *table, const void *key, size_t klen, u32 hash, int *found)
+{
+    if (table->old) {
+        dlb_hash_rehash_step(table, DLB_HASH_REHASH_STEP);
+    }
+    size_t index = _dlb_hash_find(table, key, klen, hash, 0);
+    if (index != _DLB_HASH_NONE) {
+        *found = 1;
+        return table->buckets[index].value;
     }
+    if ((index = _dlb_hash_find_old(table, key, klen, hash)) != _DLB_HASH_NONE) {
+        *found = 1;
+        return table->old->buckets[index].value;
+    }
+    *found = 0;
+    return NULL;
 }
+
 void *dlb_hash_search(dlb_hash *table, const void *key, size_t klen, int *found)
 {
 #if _DEBUG
@@ -237,26 +953,8 @@ void *dlb_hash_search(dlb_hash *table, const void *key, size_t klen, int *found)
 
     //DLB_ASSERT(key);
     DLB_ASSERT(klen);
-    void *value = NULL;
     int value_found = 0;
-
-    dlb_hash_entry *first_freed = 0;
-    dlb_hash_entry *entry = _dlb_hash_find(table, key, klen, &first_freed, 0);
-
-    if (entry && entry->klen) {
-        value = entry->value;
-        value_found = 1;
-
-        // Optimize by pushing entry into first free slot
-        if (first_freed) {
-            first_freed->key = entry->key;
-            first_freed->klen = entry->klen;
-            first_freed->value = entry->value;
-            entry->key = _DLB_HASH_FREED;
-            entry->klen = 0;
-            entry->value = 0;
-        }
-    }
+    void *value = _dlb_hash_search(table, key, klen, _dlb_hash_hash(table, key, klen), &value_found);
 
 #if _DEBUG
     if (table->debug) {
@@ -272,24 +970,188 @@ void *dlb_hash_search(dlb_hash *table, const void *key, size_t klen, int *found)
     return value;
 }
 
-// Possible improvements:
-// https://en.wikipedia.org/wiki/Lazy_deletion
-// https://attractivechaos.wordpress.com/2018/10/01/advanced-techniques-to-implement-fast-hash-tables/
+// Three passes over each chunk of keys, so the loads of one pass are in
+// flight while the next key's are issued: hash and prefetch the home group's
+// ctrl bytes, match h2 in the home group and prefetch the matching entry,
+// then do the real lookups against (hopefully) cached memory.
+size_t dlb_hash_search_batch(dlb_hash *table, const void **keys, const size_t *klens, void **out_values,
+    size_t n)
+{
+    if (table->old) {
+        dlb_hash_rehash_step(table, DLB_HASH_REHASH_STEP);
+    }
+    size_t mask = table->size - 1;
+    int robin_hood = table->flags & DLB_HASH_ROBIN_HOOD;
+    size_t hits = 0;
+    u32 hashes[_DLB_HASH_BATCH];
+    for (size_t start = 0; start < n; start += _DLB_HASH_BATCH) {
+        size_t count = MIN(n - start, _DLB_HASH_BATCH);
+        for (size_t i = 0; i < count; i++) {
+            DLB_ASSERT(klens[start + i]);
+            hashes[i] = _dlb_hash_hash(table, keys[start + i], klens[start + i]);
+            size_t home = hashes[i] & mask;
+            _dlb_hash_prefetch(table->ctrl + home);
+            if (robin_hood) {
+                // Probing is linear from home, the entry is almost always there
+                _dlb_hash_prefetch(&table->buckets[home]);
+            }
+        }
+        if (!robin_hood) {
+            for (size_t i = 0; i < count; i++) {
+                size_t home = hashes[i] & mask;
+                u32 match = _dlb_hash_group_match(table->ctrl + home, _dlb_hash_h2(hashes[i]));
+                if (match) {
+                    _dlb_hash_prefetch(&table->buckets[(home + dlb_ctz64(match)) & mask]);
+                }
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            size_t index = _dlb_hash_find(table, keys[start + i], klens[start + i], hashes[i], 0);
+            if (index != _DLB_HASH_NONE) {
+                out_values[start + i] = table->buckets[index].value;
+                hits++;
+            } else if ((index = _dlb_hash_find_old(table, keys[start + i], klens[start + i], hashes[i])) !=
+                       _DLB_HASH_NONE) {
+                out_values[start + i] = table->old->buckets[index].value;
+                hits++;
+            } else {
+                out_values[start + i] = NULL;
+            }
+        }
+    }
+    return hits;
+}
+
+// Free a full slot. If no probe window around index was ever completely
+// full, no probe sequence can have continued past this slot, so it can go
+// straight back to empty instead of leaving a tombstone.
+static void _dlb_hash_erase(dlb_hash *table, size_t index)
+{
+    size_t mask = table->size - 1;
+    u32 empty_before = _dlb_hash_group_match(table->ctrl + ((index - DLB_HASH_GROUP) & mask), DLB_HASH_CTRL_EMPTY);
+    u32 empty_after = _dlb_hash_group_match(table->ctrl + index, DLB_HASH_CTRL_EMPTY);
+    // Full/deleted slots directly before and after index
+    u32 run_before = empty_before ? dlb_clz64(empty_before) - (64 - DLB_HASH_GROUP) : DLB_HASH_GROUP;
+    u32 run_after = empty_after ? dlb_ctz64(empty_after) : DLB_HASH_GROUP;
+    if (run_before + run_after < DLB_HASH_GROUP) {
+        _dlb_hash_set_ctrl(table, index, DLB_HASH_CTRL_EMPTY);
+    } else {
+        _dlb_hash_set_ctrl(table, index, DLB_HASH_CTRL_DELETED);
+        table->tombstones++;
+    }
+    table->buckets[index].key = 0;
+    table->buckets[index].klen = 0;
+    table->buckets[index].value = 0;
+    table->count--;
+}
+
+static void _dlb_hash_delete(dlb_hash *table, const void *key, size_t klen, u32 hash)
+{
+    DLB_ASSERT(!(table->flags & DLB_HASH_FROZEN));  // Error: Frozen tables are read-only
+    if (table->old) {
+        dlb_hash_rehash_step(table, DLB_HASH_REHASH_STEP);
+    }
+    size_t index = _dlb_hash_find(table, key, klen, hash, 0);
+    if (index == _DLB_HASH_NONE) {
+        index = _dlb_hash_find_old(table, key, klen, hash);
+        if (index == _DLB_HASH_NONE) {
+            DLB_ASSERT(0);  // Error: Tried to delete non-existent key
+        } else {
+            if (table->flags & DLB_HASH_ROBIN_HOOD) {
+                _dlb_hash_rh_erase(table->old, index);
+            } else {
+                _dlb_hash_erase(table->old, index);
+            }
+            table->count--;
+        }
+    } else if (table->flags & DLB_HASH_ROBIN_HOOD) {
+        _dlb_hash_rh_erase(table, index);
+    } else {
+        _dlb_hash_erase(table, index);
+    }
+}
 
 void dlb_hash_delete(dlb_hash *table, const void *key, size_t klen)
 {
     DLB_ASSERT(key);
     DLB_ASSERT(klen);
+    _dlb_hash_delete(table, key, klen, _dlb_hash_hash(table, key, klen));
+}
 
-    dlb_hash_entry *entry = _dlb_hash_find(table, key, klen, 0, 0);
+//-- Statistics ----------------------------------------------------------------
 
-    if (entry && entry->klen) {
-        entry->key = _DLB_HASH_FREED;
-        entry->klen = 0;
-        entry->value = 0;
-    } else {
-        DLB_ASSERT(0);  // Error: Tried to delete non-existent key
+// # of groups (slots in Robin Hood mode) between the full slot at index and
+// its home
+static size_t _dlb_hash_displacement(dlb_hash *table, size_t index)
+{
+    if (table->flags & DLB_HASH_ROBIN_HOOD) {
+        return _dlb_hash_rh_dist(table, index);
+    }
+    size_t mask = table->size - 1;
+    size_t pos = table->buckets[index].hash & mask;
+    size_t i = 0;
+    while (((index - pos) & mask) >= DLB_HASH_GROUP) {
+        pos = (pos + (i + 1) * DLB_HASH_GROUP) & mask;
+        i++;
+    }
+    return i;
+}
+
+void dlb_hash_stats(dlb_hash *table, dlb_hash_statistics *stats)
+{
+    dlb_memset(stats, 0, sizeof(*stats));
+    stats->size = table->size;
+    stats->count = table->count;
+    stats->tombstones = table->tombstones;
+    stats->load_factor = (float)(_dlb_hash_current_count(table) + table->tombstones) / table->size;
+    for (dlb_hash *part = table; part; part = part->old) {
+        for (size_t i = 0; i < part->size; i++) {
+            if (_dlb_hash_ctrl_full(part->ctrl[i])) {
+                stats->max_displacement = MAX(stats->max_displacement, _dlb_hash_displacement(part, i));
+            }
+        }
     }
+#ifdef DLB_HASH_STATS
+    stats->counters = table->counters;
+    if (table->old) {
+        _dlb_hash_counters_add(&stats->counters, &table->old->counters);
+    }
+#endif
+}
+
+void dlb_hash_stats_reset(dlb_hash *table)
+{
+#ifdef DLB_HASH_STATS
+    dlb_memset(&table->counters, 0, sizeof(table->counters));
+#else
+    (void)table;
+#endif
+}
+
+//-- Integer keys --------------------------------------------------------------
+
+void dlb_hash_insert_int(dlb_hash *table, u64 key, void *value)
+{
+    DLB_ASSERT(table->type == DLB_HASH_INT);
+    DLB_ASSERT(key <= UINTPTR_MAX);
+    _dlb_hash_insert(table, (const void *)(uintptr_t)key, 0, _dlb_hash_hash_int(key), value);
+}
+
+void *dlb_hash_search_int(dlb_hash *table, u64 key, int *found)
+{
+    DLB_ASSERT(table->type == DLB_HASH_INT);
+    DLB_ASSERT(key <= UINTPTR_MAX);
+    int value_found = 0;
+    void *value = _dlb_hash_search(table, (const void *)(uintptr_t)key, 0, _dlb_hash_hash_int(key), &value_found);
+    if (found) *found = value_found;
+    return value;
+}
+
+void dlb_hash_delete_int(dlb_hash *table, u64 key)
+{
+    DLB_ASSERT(table->type == DLB_HASH_INT);
+    DLB_ASSERT(key <= UINTPTR_MAX);
+    _dlb_hash_delete(table, (const void *)(uintptr_t)key, 0, _dlb_hash_hash_int(key));
 }
 
 #endif
@@ -349,6 +1211,144 @@ void dlb_hash_test() {
     DLB_ASSERT(search_3 == 0);
 
     dlb_hash_free(table);
+
+    // Grows past the initial size, purges tombstones, and never duplicates a
+    // key stored past a tombstone. Robin Hood mode never leaves tombstones.
+    static char keys[1000][8];
+    static const u32 modes[] = { 0, DLB_HASH_ROBIN_HOOD, DLB_HASH_INCREMENTAL,
+                                 DLB_HASH_ROBIN_HOOD | DLB_HASH_INCREMENTAL };
+    for (u32 m = 0; m < ARRAY_SIZE(modes); m++) {
+        u32 flags = modes[m];
+        table->flags = flags;
+        dlb_hash_init(table, DLB_HASH_STRING, "grow", 4);
+        int migrating = 0;
+        for (int i = 0; i < 1000; i++) {
+            snprintf(keys[i], sizeof(keys[i]), "k%d", i);
+            dlb_hash_insert(table, keys[i], strlen(keys[i]), keys[i]);
+            migrating |= table->old != 0;
+        }
+        DLB_ASSERT(migrating == !!(flags & DLB_HASH_INCREMENTAL));
+        DLB_ASSERT(table->count == 1000);
+        DLB_ASSERT(table->size >= 1000 * 4 / 3);
+        for (int i = 0; i < 1000; i += 2) {
+            dlb_hash_delete(table, keys[i], strlen(keys[i]));
+        }
+        DLB_ASSERT(table->count == 500);
+        DLB_ASSERT(table->tombstones <= (flags & DLB_HASH_ROBIN_HOOD ? 0 : 500));
+        for (int i = 1; i < 1000; i += 2) {
+            dlb_hash_insert(table, keys[i], strlen(keys[i]), keys[i]);
+        }
+        DLB_ASSERT(table->count == 500);
+        dlb_hash_purge(table);
+        DLB_ASSERT(table->tombstones == 0);
+        dlb_hash_statistics stats;
+        dlb_hash_stats(table, &stats);
+        DLB_ASSERT(stats.count == 500 && stats.tombstones == 0);
+        DLB_ASSERT(stats.load_factor > 0.0f && stats.load_factor <= 0.75f);
+        DLB_ASSERT(stats.max_displacement < table->size);
+#ifdef DLB_HASH_STATS
+        u64 lookups = 0;
+        for (u32 i = 0; i < DLB_HASH_STATS_BUCKETS; i++) {
+            lookups += stats.counters.hit_probes[i] + stats.counters.miss_probes[i];
+        }
+        // Every insert looks the key up first, every delete hits
+        DLB_ASSERT(lookups >= 1000 + 500 + 500);
+        DLB_ASSERT(stats.counters.key_compares >= 500);
+#endif
+        for (int i = 0; i < 1000; i++) {
+            int found = 0;
+            void *value = dlb_hash_search(table, keys[i], strlen(keys[i]), &found);
+            DLB_ASSERT(found == (i & 1));
+            DLB_ASSERT(value == (found ? keys[i] : 0));
+        }
+        // Batch lookup matches one-at-a-time search, including a partial chunk
+        const void *batch_keys[100];
+        size_t batch_klens[100];
+        void *batch_values[100];
+        for (int i = 0; i < 100; i++) {
+            batch_keys[i] = keys[i * 7];
+            batch_klens[i] = strlen(keys[i * 7]);
+        }
+        DLB_ASSERT(dlb_hash_search_batch(table, batch_keys, batch_klens, batch_values, 100) == 50);
+        for (int i = 0; i < 100; i++) {
+            DLB_ASSERT(batch_values[i] == dlb_hash_search(table, batch_keys[i], batch_klens[i], 0));
+        }
+        // Freezing compacts to the smallest size at <= 75% load, and searches
+        // on the frozen table leave it untouched
+        for (int i = 1; i < 200; i += 2) {
+            dlb_hash_delete(table, keys[i], strlen(keys[i]));
+        }
+        dlb_hash_freeze(table, 0);
+        DLB_ASSERT(table->flags & DLB_HASH_FROZEN);
+        DLB_ASSERT(table->size == 1024 && table->count == 400 && table->tombstones == 0 && !table->old);
+        dlb_hash_stats(table, &stats);
+        for (int i = 0; i < 1000; i++) {
+            DLB_ASSERT(dlb_hash_search(table, keys[i], strlen(keys[i]), 0) == ((i & 1) && i > 200 ? keys[i] : 0));
+        }
+        DLB_ASSERT(dlb_hash_search_batch(table, batch_keys, batch_klens, batch_values, 100) == 36);
+        dlb_hash_statistics frozen_stats;
+        dlb_hash_stats(table, &frozen_stats);
+        DLB_ASSERT(!memcmp(&stats, &frozen_stats, sizeof(stats)));
+        dlb_hash_free(table);
+    }
+
+    // Owned keys survive the caller's buffer, both inline and in the arena
+    table->flags = DLB_HASH_OWNED_KEYS;
+    dlb_hash_init(table, DLB_HASH_STRING, "owned", 16);
+    char buf[64];
+    for (int i = 0; i < 100; i++) {
+        snprintf(buf, sizeof(buf), (i & 1) ? "short %d" : "a key too long to be stored inline %d", i);
+        dlb_hash_insert(table, buf, strlen(buf), keys[i]);
+    }
+    dlb_memset(buf, 0, sizeof(buf));
+    for (int i = 0; i < 100; i++) {
+        snprintf(buf, sizeof(buf), (i & 1) ? "short %d" : "a key too long to be stored inline %d", i);
+        DLB_ASSERT(dlb_hash_search(table, buf, strlen(buf), 0) == keys[i]);
+    }
+    dlb_hash_free(table);
+
+    // A grow while Robin Hood is still placing an entry compacts the arena;
+    // the pending entry's key has to move with it
+    table->flags = DLB_HASH_OWNED_KEYS | DLB_HASH_ROBIN_HOOD;
+    table->max_probes = 2;
+    dlb_hash_init(table, DLB_HASH_STRING, "owned_rh", 16);
+    for (int i = 0; i < 5000; i++) {
+        snprintf(buf, sizeof(buf), "a key too long to be stored inline %06d", i);
+        dlb_hash_insert(table, buf, strlen(buf), (void *)(uintptr_t)(i + 1));
+    }
+    DLB_ASSERT(table->count == 5000);
+    for (int i = 0; i < 5000; i++) {
+        snprintf(buf, sizeof(buf), "a key too long to be stored inline %06d", i);
+        DLB_ASSERT(dlb_hash_search(table, buf, strlen(buf), 0) == (void *)(uintptr_t)(i + 1));
+    }
+    dlb_hash_free(table);
+    table->max_probes = 0;
+
+    // Integer keys, 0 and INT32_MIN are ordinary keys
+    for (u32 m = 0; m < ARRAY_SIZE(modes); m++) {
+        table->flags = modes[m];
+        dlb_hash_init(table, DLB_HASH_INT, "int", 16);
+        const u64 special[] = { 0, (u64)(s64)INT32_MIN, UINT32_MAX, UINTPTR_MAX };
+        for (u32 i = 0; i < ARRAY_SIZE(special); i++) {
+            dlb_hash_insert_int(table, special[i], keys[i]);
+        }
+        for (u64 i = 1; i <= 1000; i++) {
+            dlb_hash_insert_int(table, i * 0x9E3779B97F4A7C15ULL, keys[i % 1000]);
+        }
+        DLB_ASSERT(table->count == 1000 + ARRAY_SIZE(special));
+        for (u32 i = 0; i < ARRAY_SIZE(special); i++) {
+            int found = 0;
+            DLB_ASSERT(dlb_hash_search_int(table, special[i], &found) == keys[i] && found);
+        }
+        dlb_hash_delete_int(table, 0);
+        int found = 1;
+        DLB_ASSERT(!dlb_hash_search_int(table, 0, &found) && !found);
+        DLB_ASSERT(dlb_hash_search_int(table, (u64)(s64)INT32_MIN, 0) == keys[1]);
+        for (u64 i = 1; i <= 1000; i++) {
+            DLB_ASSERT(dlb_hash_search_int(table, i * 0x9E3779B97F4A7C15ULL, 0) == keys[i % 1000]);
+        }
+        dlb_hash_free(table);
+    }
 }
 
 #endif
@@ -0,0 +1,502 @@
+#ifndef DLB_HASH_CONCURRENT_H
+#define DLB_HASH_CONCURRENT_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Hash table shared by many threads: lock-free reads, striped writer locks.
+//
+// Readers never lock and never write to shared memory, so lookups scale with
+// cores. Each slot is an atomic pointer to an immutable node holding the hash,
+// a copy of the key and an atomic value. Writers lock one of
+// DLB_HASH_CONCURRENT_STRIPES mutexes picked by hash, so writers of different
+// keys mostly run in parallel; they claim empty slots with a CAS since two
+// stripes can probe into the same slot. Delete leaves a tombstone, resize
+// takes every stripe and publishes a new slot array.
+//
+// Nodes and old slot arrays are freed through epoch-based reclamation: every
+// operation pins the calling thread's epoch, and memory unlinked by a writer
+// is only freed once no thread is pinned at an epoch that could still see it.
+// So each thread needs a handle:
+#if 0
+    dlb_hash_concurrent table = { 0 };
+    dlb_hash_concurrent_init(&table, 64, 1024);   // max_threads, size_pow2
+
+    // In each worker
+    dlb_hash_concurrent_thread *self = dlb_hash_concurrent_register(&table);
+    dlb_hash_concurrent_insert(&table, self, key, klen, value);
+    void *value = dlb_hash_concurrent_search(&table, self, key, klen, &found);
+    dlb_hash_concurrent_unregister(&table, self);
+#endif
+//
+// Keys are compared as raw bytes and always copied. Values are opaque
+// pointers; the table doesn't manage what they point to.
+//
+// Requires DLB_MURMUR3_IMPLEMENTATION and DLB_VECTOR_IMPLEMENTATION in some
+// translation unit.
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_memory.h"
+#include "dlb_murmur3.h"
+#include "dlb_vector.h"
+#include <atomic>
+#include <mutex>
+
+#define DLB_HASH_CONCURRENT_STRIPES 64
+static_assert(DLB_HASH_CONCURRENT_STRIPES > 0 && DLB_HASH_CONCURRENT_STRIPES <= (1 << 16) &&
+                  !(DLB_HASH_CONCURRENT_STRIPES & (DLB_HASH_CONCURRENT_STRIPES - 1)),
+              "DLB_HASH_CONCURRENT_STRIPES must be a power of 2, at most 2^16");
+
+typedef struct dlb_hash_concurrent_node {
+    u32 hash;
+    u32 klen;
+    std::atomic<void *> value;
+    char key[1];  // klen bytes
+} dlb_hash_concurrent_node;
+
+typedef struct dlb_hash_concurrent_slots {
+    size_t size;  // power of 2
+    std::atomic<dlb_hash_concurrent_node *> slots[1];  // size slots
+} dlb_hash_concurrent_slots;
+
+// Per-thread reclamation state, one cache line each so pinning never
+// false-shares
+typedef struct alignas(64) dlb_hash_concurrent_thread {
+    std::atomic<u64> epoch;  // 0 = not inside an operation
+    std::atomic<bool> registered;
+} dlb_hash_concurrent_thread;
+
+typedef struct alignas(64) dlb_hash_concurrent_stripe {
+    std::mutex lock;
+} dlb_hash_concurrent_stripe;
+
+typedef struct dlb_hash_concurrent_retired {
+    void *ptr;
+    u64 epoch;  // global epoch when ptr was unlinked
+} dlb_hash_concurrent_retired;
+
+typedef struct dlb_hash_concurrent {
+    std::atomic<dlb_hash_concurrent_slots *> table;
+    std::atomic<size_t> count;  // # of live entries
+    std::atomic<size_t> used;   // # of non-empty slots (live + tombstones)
+    std::atomic<u64> epoch;
+    u32 max_threads;
+    dlb_hash_concurrent_thread *threads;
+    dlb_hash_concurrent_stripe *stripes;
+    std::mutex retired_lock;
+    dlb_hash_concurrent_retired *retired;  // dlb_vec
+} dlb_hash_concurrent;
+
+// Not thread-safe; call before sharing the table / after all threads are done
+void dlb_hash_concurrent_init(dlb_hash_concurrent *table, u32 max_threads, size_t size_pow2);
+void dlb_hash_concurrent_free(dlb_hash_concurrent *table);
+
+// Asserts if more than max_threads threads are registered at once
+dlb_hash_concurrent_thread *dlb_hash_concurrent_register(dlb_hash_concurrent *table);
+void dlb_hash_concurrent_unregister(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread);
+
+// Insert or overwrite
+void dlb_hash_concurrent_insert(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread,
+                                const void *key, size_t klen, void *value);
+// Lock-free. Returns the value, or NULL with *found = 0 if the key isn't there.
+void *dlb_hash_concurrent_search(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread,
+                                 const void *key, size_t klen, int *found);
+// Returns false if key wasn't found
+bool dlb_hash_concurrent_delete(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread,
+                                const void *key, size_t klen);
+
+void dlb_hash_concurrent_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_HASH_CONCURRENT_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_HASH_CONCURRENT_IMPLEMENTATION
+#ifndef DLB_HASH_CONCURRENT_IMPL_INTERNAL
+#define DLB_HASH_CONCURRENT_IMPL_INTERNAL
+
+#include <new>
+#include <stddef.h>
+#include <string.h>
+
+// Slot value left behind by delete so probe chains stay intact
+#define DLB_HASH_CONCURRENT__TOMBSTONE ((dlb_hash_concurrent_node *)1)
+// Free retired memory once this many items have piled up
+#define DLB_HASH_CONCURRENT__RECLAIM_BATCH 64
+
+static dlb_hash_concurrent_slots *dlb_hash_concurrent__alloc(size_t size)
+{
+    dlb_hash_concurrent_slots *slots = (dlb_hash_concurrent_slots *)dlb_malloc(
+        sizeof(dlb_hash_concurrent_slots) + (size - 1) * sizeof(slots->slots[0]));
+    slots->size = size;
+    for (size_t i = 0; i < size; i++) {
+        new (&slots->slots[i]) std::atomic<dlb_hash_concurrent_node *>(0);
+    }
+    return slots;
+}
+
+// Mark the thread as inside an operation at the current epoch. The fence
+// pairs with the one in __reclaim: a writer that unlinks something and then
+// scans the threads either sees this pin, or this thread's loads that follow
+// see the unlink.
+static inline void dlb_hash_concurrent__pin(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread)
+{
+    DLB_ASSERT(thread->epoch.load(std::memory_order_relaxed) == 0);
+    thread->epoch.store(table->epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+static inline void dlb_hash_concurrent__unpin(dlb_hash_concurrent_thread *thread)
+{
+    thread->epoch.store(0, std::memory_order_release);
+}
+
+// Free retired items that no pinned thread can still reach
+static void dlb_hash_concurrent__reclaim(dlb_hash_concurrent *table)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    u64 oldest = UINT64_MAX;
+    for (u32 i = 0; i < table->max_threads; i++) {
+        u64 epoch = table->threads[i].epoch.load(std::memory_order_acquire);
+        if (epoch) {
+            oldest = MIN(oldest, epoch);
+        }
+    }
+    dlb_hash_concurrent_retired *keep = table->retired;
+    for (dlb_hash_concurrent_retired *it = table->retired; it != dlb_vec_end(table->retired); it++) {
+        if (it->epoch < oldest) {
+            dlb_free(it->ptr);
+        } else {
+            *keep++ = *it;
+        }
+    }
+    if (table->retired) {
+        dlb_vec_hdr(table->retired)->len = keep - table->retired;
+    }
+}
+
+// Call after ptr has been unlinked from the table
+static void dlb_hash_concurrent__retire(dlb_hash_concurrent *table, void *ptr)
+{
+    // Threads pinned from here on see the new epoch, which is past ptr's
+    u64 epoch = table->epoch.fetch_add(1, std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> guard(table->retired_lock);
+    dlb_hash_concurrent_retired *retired = (dlb_hash_concurrent_retired *)dlb_vec_alloc(table->retired);
+    retired->ptr = ptr;
+    retired->epoch = epoch;
+    if (dlb_vec_len(table->retired) >= DLB_HASH_CONCURRENT__RECLAIM_BATCH) {
+        dlb_hash_concurrent__reclaim(table);
+    }
+}
+
+static inline bool dlb_hash_concurrent__match(const dlb_hash_concurrent_node *node, u32 hash,
+                                              const void *key, size_t klen)
+{
+    return node->hash == hash && node->klen == klen && !memcmp(node->key, key, klen);
+}
+
+// Index of key's slot, or SIZE_MAX. Safe without a lock while pinned.
+static size_t dlb_hash_concurrent__find(dlb_hash_concurrent_slots *slots, u32 hash, const void *key,
+                                        size_t klen, dlb_hash_concurrent_node **node)
+{
+    size_t mask = slots->size - 1;
+    size_t pos = hash & mask;
+    for (size_t i = 0; i < slots->size; i++) {
+        dlb_hash_concurrent_node *n = slots->slots[pos].load(std::memory_order_acquire);
+        if (!n) {
+            break;
+        }
+        if (n != DLB_HASH_CONCURRENT__TOMBSTONE && dlb_hash_concurrent__match(n, hash, key, klen)) {
+            *node = n;
+            return pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return SIZE_MAX;
+}
+
+static inline dlb_hash_concurrent_stripe *dlb_hash_concurrent__stripe(dlb_hash_concurrent *table, u32 hash)
+{
+    // Low bits pick the home slot, use high bits so neighboring homes spread
+    return &table->stripes[(hash >> 16) & (DLB_HASH_CONCURRENT_STRIPES - 1)];
+}
+
+// Rebuild with every stripe held, doubling if live entries pass 50% load
+static void dlb_hash_concurrent__resize(dlb_hash_concurrent *table, size_t seen_size)
+{
+    for (u32 i = 0; i < DLB_HASH_CONCURRENT_STRIPES; i++) {
+        table->stripes[i].lock.lock();
+    }
+    dlb_hash_concurrent_slots *old = table->table.load(std::memory_order_relaxed);
+    // Another writer may have resized while we waited for the locks
+    if (old->size == seen_size) {
+        size_t count = table->count.load(std::memory_order_relaxed);
+        size_t size = (count + 1) * 2 > old->size ? old->size * 2 : old->size;
+        dlb_hash_concurrent_slots *slots = dlb_hash_concurrent__alloc(size);
+        size_t mask = size - 1;
+        for (size_t i = 0; i < old->size; i++) {
+            dlb_hash_concurrent_node *node = old->slots[i].load(std::memory_order_relaxed);
+            if (node && node != DLB_HASH_CONCURRENT__TOMBSTONE) {
+                size_t pos = node->hash & mask;
+                while (slots->slots[pos].load(std::memory_order_relaxed)) {
+                    pos = (pos + 1) & mask;
+                }
+                slots->slots[pos].store(node, std::memory_order_relaxed);
+            }
+        }
+        table->used.store(count, std::memory_order_relaxed);
+        // Release publishes the slot contents along with the array
+        table->table.store(slots, std::memory_order_release);
+    } else {
+        old = 0;
+    }
+    for (u32 i = DLB_HASH_CONCURRENT_STRIPES; i > 0; i--) {
+        table->stripes[i - 1].lock.unlock();
+    }
+    if (old) {
+        dlb_hash_concurrent__retire(table, old);
+    }
+}
+
+void dlb_hash_concurrent_init(dlb_hash_concurrent *table, u32 max_threads, size_t size_pow2)
+{
+    DLB_ASSERT(max_threads);
+    DLB_ASSERT(size_pow2 && (size_pow2 & (size_pow2 - 1)) == 0);
+    table->table.store(dlb_hash_concurrent__alloc(MAX(size_pow2, 16)), std::memory_order_relaxed);
+    table->count.store(0, std::memory_order_relaxed);
+    table->used.store(0, std::memory_order_relaxed);
+    table->epoch.store(1, std::memory_order_relaxed);
+    table->max_threads = max_threads;
+    table->threads = new dlb_hash_concurrent_thread[max_threads];
+    for (u32 i = 0; i < max_threads; i++) {
+        table->threads[i].epoch.store(0, std::memory_order_relaxed);
+        table->threads[i].registered.store(false, std::memory_order_relaxed);
+    }
+    table->stripes = new dlb_hash_concurrent_stripe[DLB_HASH_CONCURRENT_STRIPES];
+    table->retired = 0;
+}
+
+void dlb_hash_concurrent_free(dlb_hash_concurrent *table)
+{
+    dlb_hash_concurrent_slots *slots = table->table.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < slots->size; i++) {
+        dlb_hash_concurrent_node *node = slots->slots[i].load(std::memory_order_relaxed);
+        if (node && node != DLB_HASH_CONCURRENT__TOMBSTONE) {
+            dlb_free(node);
+        }
+    }
+    dlb_free(slots);
+    for (dlb_hash_concurrent_retired *it = table->retired; it != dlb_vec_end(table->retired); it++) {
+        dlb_free(it->ptr);
+    }
+    dlb_vec_free(table->retired);
+    delete[] table->threads;
+    delete[] table->stripes;
+    table->table.store(0, std::memory_order_relaxed);
+    table->threads = 0;
+    table->stripes = 0;
+}
+
+dlb_hash_concurrent_thread *dlb_hash_concurrent_register(dlb_hash_concurrent *table)
+{
+    for (u32 i = 0; i < table->max_threads; i++) {
+        bool expected = false;
+        if (!table->threads[i].registered.load(std::memory_order_relaxed) &&
+            table->threads[i].registered.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return &table->threads[i];
+        }
+    }
+    DLB_ASSERT(!"dlb_hash_concurrent: more than max_threads threads registered");
+    return 0;
+}
+
+void dlb_hash_concurrent_unregister(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread)
+{
+    DLB_ASSERT(thread >= table->threads && thread < table->threads + table->max_threads);
+    DLB_ASSERT(thread->epoch.load(std::memory_order_relaxed) == 0);
+    thread->registered.store(false, std::memory_order_release);
+}
+
+void dlb_hash_concurrent_insert(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread,
+                                const void *key, size_t klen, void *value)
+{
+    DLB_ASSERT(klen <= UINT32_MAX);
+    u32 hash = dlb_murmur3(key, klen);
+    dlb_hash_concurrent_stripe *stripe = dlb_hash_concurrent__stripe(table, hash);
+    dlb_hash_concurrent_node *node = 0;
+
+    dlb_hash_concurrent__pin(table, thread);
+    for (;;) {
+        stripe->lock.lock();
+        // Can't change while we hold a stripe, resize needs all of them
+        dlb_hash_concurrent_slots *slots = table->table.load(std::memory_order_acquire);
+
+        // Same key => same stripe, so nobody else can insert it meanwhile
+        dlb_hash_concurrent_node *existing;
+        if (dlb_hash_concurrent__find(slots, hash, key, klen, &existing) != SIZE_MAX) {
+            existing->value.store(value, std::memory_order_release);
+            stripe->lock.unlock();
+            // Another insert of key got in while we were resizing
+            dlb_free(node);
+            break;
+        }
+
+        if (!node) {
+            node = (dlb_hash_concurrent_node *)dlb_malloc(offsetof(dlb_hash_concurrent_node, key) + MAX(klen, 1));
+            node->hash = hash;
+            node->klen = (u32)klen;
+            new (&node->value) std::atomic<void *>(value);
+            memcpy(node->key, key, klen);
+        }
+
+        // Take the first tombstone or empty slot. Writers on other stripes
+        // race for the same slots, hence the CAS.
+        size_t mask = slots->size - 1;
+        size_t pos = hash & mask;
+        bool placed = false;
+        bool full = false;
+        for (size_t i = 0; i < slots->size; i++) {
+            dlb_hash_concurrent_node *cur = slots->slots[pos].load(std::memory_order_relaxed);
+            if (!cur) {
+                // Filling an empty slot lengthens probe chains, keep load < 75%
+                if ((table->used.fetch_add(1, std::memory_order_relaxed) + 1) * 4 > slots->size * 3) {
+                    table->used.fetch_sub(1, std::memory_order_relaxed);
+                    full = true;
+                    break;
+                }
+                if (slots->slots[pos].compare_exchange_strong(cur, node, std::memory_order_release,
+                                                              std::memory_order_relaxed)) {
+                    placed = true;
+                    break;
+                }
+                table->used.fetch_sub(1, std::memory_order_relaxed);
+            } else if (cur == DLB_HASH_CONCURRENT__TOMBSTONE) {
+                if (slots->slots[pos].compare_exchange_strong(cur, node, std::memory_order_release,
+                                                              std::memory_order_relaxed)) {
+                    placed = true;
+                    break;
+                }
+            }
+            pos = (pos + 1) & mask;
+        }
+        stripe->lock.unlock();
+
+        if (placed) {
+            table->count.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        DLB_ASSERT(full);
+        dlb_hash_concurrent__resize(table, slots->size);
+    }
+    dlb_hash_concurrent__unpin(thread);
+}
+
+void *dlb_hash_concurrent_search(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread,
+                                 const void *key, size_t klen, int *found)
+{
+    u32 hash = dlb_murmur3(key, klen);
+    void *value = 0;
+    dlb_hash_concurrent_node *node;
+
+    dlb_hash_concurrent__pin(table, thread);
+    dlb_hash_concurrent_slots *slots = table->table.load(std::memory_order_acquire);
+    bool hit = dlb_hash_concurrent__find(slots, hash, key, klen, &node) != SIZE_MAX;
+    if (hit) {
+        value = node->value.load(std::memory_order_acquire);
+    }
+    dlb_hash_concurrent__unpin(thread);
+
+    if (found) *found = hit;
+    return value;
+}
+
+bool dlb_hash_concurrent_delete(dlb_hash_concurrent *table, dlb_hash_concurrent_thread *thread,
+                                const void *key, size_t klen)
+{
+    u32 hash = dlb_murmur3(key, klen);
+    dlb_hash_concurrent_stripe *stripe = dlb_hash_concurrent__stripe(table, hash);
+    dlb_hash_concurrent_node *node;
+
+    dlb_hash_concurrent__pin(table, thread);
+    stripe->lock.lock();
+    dlb_hash_concurrent_slots *slots = table->table.load(std::memory_order_acquire);
+    size_t pos = dlb_hash_concurrent__find(slots, hash, key, klen, &node);
+    if (pos != SIZE_MAX) {
+        // Only this stripe writes key's slot while it's full
+        slots->slots[pos].store(DLB_HASH_CONCURRENT__TOMBSTONE, std::memory_order_release);
+        table->count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    stripe->lock.unlock();
+    dlb_hash_concurrent__unpin(thread);
+
+    if (pos != SIZE_MAX) {
+        dlb_hash_concurrent__retire(table, node);
+    }
+    return pos != SIZE_MAX;
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_HASH_CONCURRENT_TEST
+
+#include <thread>
+
+void dlb_hash_concurrent_test()
+{
+    const u32 threads = 4;
+    const u32 per_thread = 5000;
+    dlb_hash_concurrent table;
+    dlb_hash_concurrent_init(&table, threads + 1, 16);
+
+    // Each writer owns a key range; readers of other ranges run alongside.
+    // Odd keys are deleted again, even keys must survive every resize.
+    std::thread workers[threads];
+    for (u32 t = 0; t < threads; t++) {
+        workers[t] = std::thread([&table, t, per_thread]() {
+            dlb_hash_concurrent_thread *self = dlb_hash_concurrent_register(&table);
+            for (u32 i = 0; i < per_thread; i++) {
+                u32 key = t * per_thread + i;
+                dlb_hash_concurrent_insert(&table, self, &key, sizeof(key), (void *)(size_t)(key + 1));
+                int found = 0;
+                u32 other = ((t + 1) % threads) * per_thread + i;
+                void *value = dlb_hash_concurrent_search(&table, self, &other, sizeof(other), &found);
+                DLB_ASSERT(!found || value == (void *)(size_t)(other + 1));
+                if (key & 1) {
+                    DLB_ASSERT(dlb_hash_concurrent_delete(&table, self, &key, sizeof(key)));
+                }
+            }
+            dlb_hash_concurrent_unregister(&table, self);
+        });
+    }
+    for (u32 t = 0; t < threads; t++) {
+        workers[t].join();
+    }
+
+    dlb_hash_concurrent_thread *self = dlb_hash_concurrent_register(&table);
+    DLB_ASSERT(table.count.load() == threads * per_thread / 2);
+    for (u32 key = 0; key < threads * per_thread; key++) {
+        int found = 0;
+        void *value = dlb_hash_concurrent_search(&table, self, &key, sizeof(key), &found);
+        DLB_ASSERT(found == !(key & 1));
+        DLB_ASSERT(!found || value == (void *)(size_t)(key + 1));
+    }
+    u32 key = 42;
+    dlb_hash_concurrent_insert(&table, self, &key, sizeof(key), (void *)7);
+    DLB_ASSERT(dlb_hash_concurrent_search(&table, self, &key, sizeof(key), 0) == (void *)7);
+    DLB_ASSERT(!dlb_hash_concurrent_delete(&table, self, "missing", 7));
+    dlb_hash_concurrent_unregister(&table, self);
+    dlb_hash_concurrent_free(&table);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
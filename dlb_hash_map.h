@@ -0,0 +1,324 @@
+#ifndef DLB_HASH_MAP_H
+#define DLB_HASH_MAP_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Typed hash map: dlb::hash_map<K, V, Hash, Eq>.
+//
+// Same SwissTable layout as dlb_hash (control bytes probed a group at a time,
+// see dlb_hash.h), but keys and values are stored inline in the slots and the
+// hash/equality functions are template parameters, so there's no per-call
+// type switch and no pointer chasing to reach a key or value.
+//
+// Lookups are heterogeneous: any type Q that Hash and Eq accept alongside K
+// works, e.g. find a std::string key with a std::string_view or const char *
+// without building a temporary std::string.
+#if 0
+    dlb::hash_map<std::string, int> ids;
+    ids.insert("alpha", 1);
+    int *id = ids.find(std::string_view("alpha"));
+    ids.each([](const std::string &key, int &value) { ... });
+#endif
+//
+// Requires C++17 and DLB_MURMUR3_IMPLEMENTATION in some translation unit for
+// the string hashes.
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_memory.h"
+#include "dlb_hash.h"
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace dlb {
+
+// Default hashes. Must return the same value for every key type that
+// compares equal, e.g. std::string and std::string_view.
+template <typename K, typename Enable = void>
+struct hash;
+
+// Integers, enums and pointers: fmix64 finalizer from MurmurHash3
+template <typename K>
+struct hash<K, typename std::enable_if<std::is_integral<K>::value || std::is_enum<K>::value ||
+                                       std::is_pointer<K>::value>::type> {
+    u32 operator()(K key) const
+    {
+        u64 x = (u64)key;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return (u32)x;
+    }
+};
+
+template <>
+struct hash<std::string_view> {
+    u32 operator()(std::string_view key) const
+    {
+        return dlb_murmur3(key.data(), key.size());
+    }
+};
+
+// Accepts std::string, std::string_view and const char * alike
+template <>
+struct hash<std::string> : hash<std::string_view> {
+};
+
+template <typename K, typename V, typename Hash = hash<K>, typename Eq = std::equal_to<>>
+class hash_map {
+public:
+    struct slot {
+        K key;
+        V value;
+    };
+
+    size_t capacity;    // # of slots, power of 2
+    size_t count;       // # of live entries
+    size_t tombstones;  // # of DLB_HASH_CTRL_DELETED slots
+    u8 *ctrl;           // capacity + DLB_HASH_GROUP - 1 control bytes, see dlb_hash
+    slot *slots;        // only slots with a full control byte are constructed
+
+    explicit hash_map(size_t size_pow2 = DLB_HASH_GROUP)
+    {
+        DLB_ASSERT(size_pow2 && (size_pow2 & (size_pow2 - 1)) == 0);
+        count = 0;
+        tombstones = 0;
+        alloc(MAX(size_pow2, DLB_HASH_GROUP));
+    }
+
+    ~hash_map()
+    {
+        clear();
+        dlb_free(ctrl);
+        dlb_free(slots);
+    }
+
+    hash_map(const hash_map &) = delete;
+    hash_map &operator=(const hash_map &) = delete;
+
+    // Returns pointer to the value, or NULL if not found
+    template <typename Q>
+    V *find(const Q &key)
+    {
+        size_t index = find_index(key, Hash{}(key));
+        return index == NONE ? 0 : &slots[index].value;
+    }
+
+    template <typename Q>
+    const V *find(const Q &key) const
+    {
+        return const_cast<hash_map *>(this)->find(key);
+    }
+
+    // Insert or overwrite. Returns pointer to the stored value, valid until
+    // the next insert.
+    V *insert(K key, V value)
+    {
+        u32 hash = Hash{}(key);
+        size_t index = find_index(key, hash);
+        if (index != NONE) {
+            slots[index].value = std::move(value);
+            return &slots[index].value;
+        }
+
+        index = find_free(hash);
+        if (ctrl[index] == DLB_HASH_CTRL_EMPTY && (count + tombstones + 1) * 4 > capacity * 3) {
+            grow();
+            index = find_free(hash);
+        }
+        if (ctrl[index] == DLB_HASH_CTRL_DELETED) {
+            tombstones--;
+        }
+        set_ctrl(index, _dlb_hash_h2(hash));
+        new (&slots[index]) slot{ std::move(key), std::move(value) };
+        count++;
+        return &slots[index].value;
+    }
+
+    // Returns false if key wasn't found
+    template <typename Q>
+    bool erase(const Q &key)
+    {
+        size_t index = find_index(key, Hash{}(key));
+        if (index == NONE) {
+            return false;
+        }
+        slots[index].~slot();
+        // Same "was never full" check as _dlb_hash_erase
+        size_t mask = capacity - 1;
+        u32 empty_before = _dlb_hash_group_match(ctrl + ((index - DLB_HASH_GROUP) & mask), DLB_HASH_CTRL_EMPTY);
+        u32 empty_after = _dlb_hash_group_match(ctrl + index, DLB_HASH_CTRL_EMPTY);
+        u32 run_before = empty_before ? dlb_clz64(empty_before) - (64 - DLB_HASH_GROUP) : DLB_HASH_GROUP;
+        u32 run_after = empty_after ? dlb_ctz64(empty_after) : DLB_HASH_GROUP;
+        if (run_before + run_after < DLB_HASH_GROUP) {
+            set_ctrl(index, DLB_HASH_CTRL_EMPTY);
+        } else {
+            set_ctrl(index, DLB_HASH_CTRL_DELETED);
+            tombstones++;
+        }
+        count--;
+        return true;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < capacity; i++) {
+            if (_dlb_hash_ctrl_full(ctrl[i])) {
+                slots[i].~slot();
+            }
+        }
+        dlb_memset(ctrl, (char)DLB_HASH_CTRL_EMPTY, capacity + DLB_HASH_GROUP - 1);
+        count = 0;
+        tombstones = 0;
+    }
+
+    // Calls fn(const K &key, V &value) for every entry, in slot order
+    template <typename F>
+    void each(F &&fn)
+    {
+        for (size_t i = 0; i < capacity; i++) {
+            if (_dlb_hash_ctrl_full(ctrl[i])) {
+                fn((const K &)slots[i].key, slots[i].value);
+            }
+        }
+    }
+
+private:
+    static const size_t NONE = SIZE_MAX;
+
+    void alloc(size_t size)
+    {
+        capacity = size;
+        // All DLB_HASH_CTRL_EMPTY
+        ctrl = (u8 *)dlb_calloc(capacity + DLB_HASH_GROUP - 1, 1);
+        slots = (slot *)dlb_malloc(capacity * sizeof(slot));
+    }
+
+    void set_ctrl(size_t index, u8 c)
+    {
+        ctrl[index] = c;
+        if (index < DLB_HASH_GROUP - 1) {
+            ctrl[capacity + index] = c;
+        }
+    }
+
+    // Probes groups in the same triangular sequence as _dlb_hash_find
+    template <typename Q>
+    size_t find_index(const Q &key, u32 hash) const
+    {
+        size_t mask = capacity - 1;
+        size_t pos = hash & mask;
+        u8 h2 = _dlb_hash_h2(hash);
+        for (size_t i = 0; i < capacity / DLB_HASH_GROUP; i++) {
+            const u8 *group = ctrl + pos;
+            for (u32 match = _dlb_hash_group_match(group, h2); match; match &= match - 1) {
+                size_t index = (pos + dlb_ctz64(match)) & mask;
+                if (Eq{}(slots[index].key, key)) {
+                    return index;
+                }
+            }
+            if (_dlb_hash_group_match(group, DLB_HASH_CTRL_EMPTY)) {
+                break;
+            }
+            pos = (pos + (i + 1) * DLB_HASH_GROUP) & mask;
+        }
+        return NONE;
+    }
+
+    // First empty or deleted slot on hash's probe sequence. Load is kept
+    // under 75%, so there always is one.
+    size_t find_free(u32 hash) const
+    {
+        size_t mask = capacity - 1;
+        size_t pos = hash & mask;
+        for (size_t i = 0;; i++) {
+            u32 free = _dlb_hash_group_match_free(ctrl + pos);
+            if (free) {
+                return (pos + dlb_ctz64(free)) & mask;
+            }
+            pos = (pos + (i + 1) * DLB_HASH_GROUP) & mask;
+        }
+    }
+
+    // Double if live entries would pass 50% load, otherwise just drop tombstones
+    void grow()
+    {
+        u8 *old_ctrl = ctrl;
+        slot *old_slots = slots;
+        size_t old_capacity = capacity;
+        alloc((count + 1) * 2 > capacity ? capacity * 2 : capacity);
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (_dlb_hash_ctrl_full(old_ctrl[i])) {
+                u32 hash = Hash{}(old_slots[i].key);
+                size_t index = find_free(hash);
+                set_ctrl(index, _dlb_hash_h2(hash));
+                new (&slots[index]) slot(std::move(old_slots[i]));
+                old_slots[i].~slot();
+            }
+        }
+        dlb_free(old_ctrl);
+        dlb_free(old_slots);
+        tombstones = 0;
+    }
+};
+
+} // namespace dlb
+
+void dlb_hash_map_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_HASH_MAP_TEST
+
+void dlb_hash_map_test()
+{
+    // Integer keys, churn through several grows and tombstone purges
+    {
+        dlb::hash_map<u64, u32> map;
+        for (u64 i = 0; i < 10000; i++) {
+            map.insert(i * 7919, (u32)i);
+        }
+        DLB_ASSERT(map.count == 10000);
+        for (u64 i = 0; i < 10000; i += 2) {
+            DLB_ASSERT(map.erase(i * 7919));
+        }
+        DLB_ASSERT(!map.erase((u64)2 * 7919));
+        DLB_ASSERT(map.count == 5000);
+        for (u64 i = 0; i < 10000; i++) {
+            u32 *value = map.find(i * 7919);
+            DLB_ASSERT((value != 0) == (i & 1));
+            DLB_ASSERT(!value || *value == (u32)i);
+        }
+        u64 sum = 0;
+        map.each([&](const u64 &, u32 &value) { sum += value; });
+        DLB_ASSERT(sum == 5000ULL * 5000ULL);
+    }
+
+    // String keys with heterogeneous lookup
+    {
+        dlb::hash_map<std::string, std::string> map;
+        map.insert("alpha", "1");
+        map.insert(std::string("beta"), "2");
+        DLB_ASSERT(*map.find(std::string_view("alpha")) == "1");
+        DLB_ASSERT(*map.find("beta") == "2");
+        DLB_ASSERT(!map.find("gamma"));
+        map.insert("alpha", "3");
+        DLB_ASSERT(map.count == 2);
+        DLB_ASSERT(*map.find(std::string("alpha")) == "3");
+        DLB_ASSERT(map.erase(std::string_view("beta")));
+        DLB_ASSERT(!map.find("beta"));
+    }
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
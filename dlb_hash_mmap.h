@@ -0,0 +1,473 @@
+#ifndef DLB_HASH_MMAP_H
+#define DLB_HASH_MMAP_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Read-only dlb_hash snapshot that is built once, written to disk, and
+// memory-mapped at startup. Opening costs one mmap, regardless of the number
+// of entries. Lookups read the mapped pages directly, and every process that
+// maps the same file shares one copy in the page cache.
+#if 0
+    // Build step
+    dlb_hash_mmap_write(&table, "ids.dlbh");
+
+    // At startup
+    dlb_hash_mmap ids = { 0 };
+    if (dlb_hash_mmap_open(&ids, "ids.dlbh")) {
+        u64 id = (u64)(uintptr_t)dlb_hash_mmap_search(&ids, key, klen, &found);
+    }
+    dlb_hash_mmap_close(&ids);
+#endif
+//
+// The file uses the same control bytes and group probing as dlb_hash. Entry
+// pointers become offsets, and all key bytes live in one blob:
+//
+//   dlb_hash_mmap_header
+//   ctrl    size + DLB_HASH_GROUP - 1 bytes, padded to 8
+//   slots   size * dlb_hash_mmap_slot
+//   blob    key bytes of DLB_HASH_STRING tables
+//
+// Values are stored as the raw bits of the void * values, so they need to
+// mean something in another process, e.g. IDs or offsets, not pointers.
+// Integers are in native byte order; files aren't portable across
+// endianness. Open only checks that the header is consistent, so it stays one
+// mmap; lookups bounds-check each key range they read against the blob.
+//
+// Write goes to path + ".tmp" and renames it over path, so a reader never
+// maps a half-written file and existing mappings keep the old contents.
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_hash.h"
+
+// 2: empty control bytes are 0, full ones have the high bit set
+#define DLB_HASH_MMAP_VERSION 2
+
+typedef struct dlb_hash_mmap_header {
+    char magic[4];  // "DLBH"
+    u32 version;    // DLB_HASH_MMAP_VERSION
+    u32 type;       // dlb_hash_type
+    u32 reserved;
+    u64 size;       // # of slots, power of 2
+    u64 count;      // # of entries
+    // Byte offsets from the start of the file
+    u64 ctrl_offset;
+    u64 slots_offset;
+    u64 blob_offset;
+    u64 file_size;
+} dlb_hash_mmap_header;
+
+typedef struct dlb_hash_mmap_slot {
+    u64 key;    // blob offset (DLB_HASH_STRING) or the key itself (DLB_HASH_INT)
+    u64 value;
+    u32 klen;
+    u32 hash;
+} dlb_hash_mmap_slot;
+
+typedef struct dlb_hash_mmap {
+    const u8 *base;
+    size_t length;
+    const dlb_hash_mmap_header *header;
+    const u8 *ctrl;
+    const dlb_hash_mmap_slot *slots;
+    const char *blob;
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#endif
+} dlb_hash_mmap;
+
+// Snapshot table's live entries, including any still migrating, into a new
+// file that atomically replaces path. Returns 0 on I/O failure, leaving path
+// untouched.
+int dlb_hash_mmap_write(dlb_hash *table, const char *path);
+// Map a file written by dlb_hash_mmap_write. Returns 0 if it can't be mapped
+// or isn't a valid file.
+int dlb_hash_mmap_open(dlb_hash_mmap *map, const char *path);
+void dlb_hash_mmap_close(dlb_hash_mmap *map);
+
+// Returns the value, or NULL with *found = 0 if the key isn't there
+void *dlb_hash_mmap_search(const dlb_hash_mmap *map, const void *key, size_t klen, int *found);
+void *dlb_hash_mmap_search_int(const dlb_hash_mmap *map, u64 key, int *found);
+
+void dlb_hash_mmap_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_HASH_MMAP_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_HASH_MMAP_IMPLEMENTATION
+#ifndef DLB_HASH_MMAP_IMPL_INTERNAL
+#define DLB_HASH_MMAP_IMPL_INTERNAL
+
+#include "dlb_memory.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char dlb_hash_mmap__magic[4] = { 'D', 'L', 'B', 'H' };
+
+// Run body for every live entry of table, including any still in the old
+// buckets of an incremental migration. part is the dlb_hash holding entry.
+#define DLB_HASH_MMAP__EACH(table, part, entry, ...)                             \
+    for (dlb_hash *part = (table); part; part = part->old) {                    \
+        for (size_t i_ = 0; i_ < part->size; i_++) {                            \
+            if (!_dlb_hash_ctrl_full(part->ctrl[i_])) continue;                 \
+            const dlb_hash_entry *entry = &part->buckets[i_];                   \
+            __VA_ARGS__                                                         \
+        }                                                                       \
+    }
+
+int dlb_hash_mmap_write(dlb_hash *table, const char *path)
+{
+    // Same 75% max load as dlb_hash, no tombstones to account for
+    size_t size = DLB_HASH_GROUP;
+    while (table->count * 4 > size * 3) {
+        size <<= 1;
+    }
+    size_t ctrl_bytes = ALIGN_UP(size + DLB_HASH_GROUP - 1, 8);
+    size_t blob_bytes = 0;
+    if (table->type == DLB_HASH_STRING) {
+        DLB_HASH_MMAP__EACH(table, part, entry, blob_bytes += entry->klen;)
+    }
+
+    dlb_hash_mmap_header header = { 0 };
+    memcpy(header.magic, dlb_hash_mmap__magic, sizeof(header.magic));
+    header.version = DLB_HASH_MMAP_VERSION;
+    header.type = table->type;
+    header.size = size;
+    header.count = table->count;
+    header.ctrl_offset = sizeof(header);
+    header.slots_offset = header.ctrl_offset + ctrl_bytes;
+    header.blob_offset = header.slots_offset + size * sizeof(dlb_hash_mmap_slot);
+    header.file_size = header.blob_offset + blob_bytes;
+
+    u8 *ctrl = (u8 *)dlb_malloc(ctrl_bytes);
+    dlb_memset(ctrl, (char)DLB_HASH_CTRL_EMPTY, ctrl_bytes);
+    dlb_hash_mmap_slot *slots = (dlb_hash_mmap_slot *)dlb_calloc(size, sizeof(*slots));
+    char *blob = (char *)dlb_malloc(MAX(blob_bytes, 1));
+
+    // Place each entry in the first free slot of the same triangular group
+    // sequence _dlb_hash_find probes
+    size_t mask = size - 1;
+    u64 blob_pos = 0;
+    DLB_HASH_MMAP__EACH(table, part, entry, {
+        size_t pos = entry->hash & mask;
+        u32 free;
+        for (size_t i = 0; !(free = _dlb_hash_group_match_free(ctrl + pos)); i++) {
+            pos = (pos + (i + 1) * DLB_HASH_GROUP) & mask;
+        }
+        size_t index = (pos + dlb_ctz64(free)) & mask;
+        ctrl[index] = _dlb_hash_h2(entry->hash);
+        if (index < DLB_HASH_GROUP - 1) {
+            ctrl[size + index] = ctrl[index];
+        }
+        dlb_hash_mmap_slot *slot = &slots[index];
+        if (table->type == DLB_HASH_STRING) {
+            memcpy(blob + blob_pos, dlb_hash_entry_key(part, entry), entry->klen);
+            slot->key = blob_pos;
+            blob_pos += entry->klen;
+        } else {
+            slot->key = (u64)(uintptr_t)entry->key;
+        }
+        slot->value = (u64)(uintptr_t)entry->value;
+        slot->klen = entry->klen;
+        slot->hash = entry->hash;
+    })
+
+    size_t path_len = strlen(path);
+    char *tmp_path = (char *)dlb_malloc(path_len + sizeof(".tmp"));
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", sizeof(".tmp"));
+
+    int ok = 0;
+    FILE *file = fopen(tmp_path, "wb");
+    if (file) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(ctrl, ctrl_bytes, 1, file) == 1 &&
+             fwrite(slots, size * sizeof(*slots), 1, file) == 1 &&
+             (!blob_bytes || fwrite(blob, blob_bytes, 1, file) == 1);
+        ok = (fclose(file) == 0) && ok;
+#ifdef _WIN32
+        ok = ok && MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING);
+#else
+        ok = ok && rename(tmp_path, path) == 0;
+#endif
+        if (!ok) {
+            remove(tmp_path);
+        }
+    }
+    dlb_free(tmp_path);
+    dlb_free(ctrl);
+    dlb_free(slots);
+    dlb_free(blob);
+    return ok;
+}
+
+// Check that the header describes a file that fits in length
+static int dlb_hash_mmap__valid(const dlb_hash_mmap_header *header, size_t length)
+{
+    if (length < sizeof(*header) || memcmp(header->magic, dlb_hash_mmap__magic, sizeof(header->magic)) ||
+        header->version != DLB_HASH_MMAP_VERSION || header->file_size != length) {
+        return 0;
+    }
+    if (header->type != DLB_HASH_STRING && header->type != DLB_HASH_INT) {
+        return 0;
+    }
+    if (header->size < DLB_HASH_GROUP || (header->size & (header->size - 1)) ||
+        header->size > length / sizeof(dlb_hash_mmap_slot)) {
+        return 0;
+    }
+    return header->ctrl_offset == sizeof(*header) &&
+           header->slots_offset >= header->ctrl_offset + header->size + DLB_HASH_GROUP - 1 &&
+           header->slots_offset % 8 == 0 &&
+           header->blob_offset == header->slots_offset + header->size * sizeof(dlb_hash_mmap_slot) &&
+           header->blob_offset <= length;
+}
+
+int dlb_hash_mmap_open(dlb_hash_mmap *map, const char *path)
+{
+    dlb_memset(map, 0, sizeof(*map));
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    LARGE_INTEGER length;
+    HANDLE mapping = 0;
+    const void *base = 0;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+        if (mapping) {
+            base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return 0;
+    }
+    map->file = file;
+    map->mapping = mapping;
+    map->base = (const u8 *)base;
+    map->length = (size_t)length.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        base = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // The mapping keeps the file alive
+    close(fd);
+    if (base == MAP_FAILED) {
+        return 0;
+    }
+    map->base = (const u8 *)base;
+    map->length = (size_t)st.st_size;
+#endif
+
+    map->header = (const dlb_hash_mmap_header *)map->base;
+    if (!dlb_hash_mmap__valid(map->header, map->length)) {
+        dlb_hash_mmap_close(map);
+        return 0;
+    }
+    map->ctrl = map->base + map->header->ctrl_offset;
+    map->slots = (const dlb_hash_mmap_slot *)(map->base + map->header->slots_offset);
+    map->blob = (const char *)map->base + map->header->blob_offset;
+    return 1;
+}
+
+void dlb_hash_mmap_close(dlb_hash_mmap *map)
+{
+    if (map->base) {
+#ifdef _WIN32
+        UnmapViewOfFile(map->base);
+        CloseHandle(map->mapping);
+        CloseHandle(map->file);
+#else
+        munmap((void *)map->base, map->length);
+#endif
+    }
+    dlb_memset(map, 0, sizeof(*map));
+}
+
+// Same probe sequence as _dlb_hash_find, against the mapped arrays
+static const dlb_hash_mmap_slot *dlb_hash_mmap__find(const dlb_hash_mmap *map, const void *key, size_t klen,
+                                                     u64 int_key, u32 hash)
+{
+    size_t size = (size_t)map->header->size;
+    size_t mask = size - 1;
+    size_t pos = hash & mask;
+    u8 h2 = _dlb_hash_h2(hash);
+    int string_keys = map->header->type == DLB_HASH_STRING;
+    u64 blob_bytes = map->header->file_size - map->header->blob_offset;
+    for (size_t i = 0; i < size / DLB_HASH_GROUP; i++) {
+        const u8 *group = map->ctrl + pos;
+        for (u32 match = _dlb_hash_group_match(group, h2); match; match &= match - 1) {
+            const dlb_hash_mmap_slot *slot = &map->slots[(pos + dlb_ctz64(match)) & mask];
+            if (slot->hash != hash) {
+                continue;
+            }
+            if (string_keys ? slot->klen == klen && slot->key <= blob_bytes && klen <= blob_bytes - slot->key &&
+                                  !memcmp(map->blob + slot->key, key, klen)
+                            : slot->key == int_key) {
+                return slot;
+            }
+        }
+        if (_dlb_hash_group_match(group, DLB_HASH_CTRL_EMPTY)) {
+            break;
+        }
+        pos = (pos + (i + 1) * DLB_HASH_GROUP) & mask;
+    }
+    return 0;
+}
+
+void *dlb_hash_mmap_search(const dlb_hash_mmap *map, const void *key, size_t klen, int *found)
+{
+    const dlb_hash_mmap_slot *slot;
+    if (map->header->type == DLB_HASH_STRING) {
+        DLB_ASSERT(klen);
+        slot = dlb_hash_mmap__find(map, key, klen, 0, dlb_murmur3(key, klen));
+    } else {
+        u64 int_key = (u64)(uintptr_t)key;
+        slot = dlb_hash_mmap__find(map, 0, 0, int_key, _dlb_hash_hash_int(int_key));
+    }
+    if (found) *found = slot != 0;
+    return slot ? (void *)(uintptr_t)slot->value : NULL;
+}
+
+void *dlb_hash_mmap_search_int(const dlb_hash_mmap *map, u64 key, int *found)
+{
+    DLB_ASSERT(map->header->type == DLB_HASH_INT);
+    const dlb_hash_mmap_slot *slot = dlb_hash_mmap__find(map, 0, 0, key, _dlb_hash_hash_int(key));
+    if (found) *found = slot != 0;
+    return slot ? (void *)(uintptr_t)slot->value : NULL;
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_HASH_MMAP_TEST
+
+void dlb_hash_mmap_test()
+{
+    const char *path = "dlb_hash_mmap_test.dlbh";
+    static char keys[2000][32];
+
+    dlb_hash table = { 0 };
+    table.flags = DLB_HASH_OWNED_KEYS;
+    dlb_hash_init(&table, DLB_HASH_STRING, "mmap", 16);
+    for (int i = 0; i < 2000; i++) {
+        snprintf(keys[i], sizeof(keys[i]), (i & 1) ? "id %d" : "a longer, arena-stored key %d", i);
+        dlb_hash_insert(&table, keys[i], strlen(keys[i]), (void *)(uintptr_t)(i + 1));
+    }
+    DLB_ASSERT(dlb_hash_mmap_write(&table, path));
+    dlb_hash_free(&table);
+
+    dlb_hash_mmap map = { 0 };
+    DLB_ASSERT(dlb_hash_mmap_open(&map, path));
+    DLB_ASSERT(map.header->count == 2000);
+    for (int i = 0; i < 2000; i++) {
+        int found = 0;
+        void *value = dlb_hash_mmap_search(&map, keys[i], strlen(keys[i]), &found);
+        DLB_ASSERT(found && value == (void *)(uintptr_t)(i + 1));
+    }
+    int found = 1;
+    DLB_ASSERT(!dlb_hash_mmap_search(&map, "missing", 7, &found) && !found);
+    dlb_hash_mmap_close(&map);
+
+    // Integer keys, including 0
+    dlb_hash_init(&table, DLB_HASH_INT, "mmap_int", 16);
+    for (u64 i = 0; i < 2000; i++) {
+        dlb_hash_insert_int(&table, i * 0x9E3779B97F4A7C15ULL, (void *)(uintptr_t)(i + 1));
+    }
+    DLB_ASSERT(dlb_hash_mmap_write(&table, path));
+    dlb_hash_free(&table);
+    DLB_ASSERT(dlb_hash_mmap_open(&map, path));
+    for (u64 i = 0; i < 2000; i++) {
+        DLB_ASSERT(dlb_hash_mmap_search_int(&map, i * 0x9E3779B97F4A7C15ULL, 0) == (void *)(uintptr_t)(i + 1));
+    }
+    DLB_ASSERT(!dlb_hash_mmap_search_int(&map, 1, 0));
+    dlb_hash_mmap_close(&map);
+
+    // Key offsets past the blob are skipped, not read
+    dlb_hash_init(&table, DLB_HASH_STRING, "mmap_bad", 16);
+    dlb_hash_insert(&table, keys[0], strlen(keys[0]), (void *)1);
+    DLB_ASSERT(dlb_hash_mmap_write(&table, path));
+    dlb_hash_free(&table);
+    DLB_ASSERT(dlb_hash_mmap_open(&map, path));
+    u64 slots_offset = map.header->slots_offset;
+    u64 size = map.header->size;
+    dlb_hash_mmap_close(&map);
+    FILE *file = fopen(path, "r+b");
+    for (u64 i = 0; i < size; i++) {
+        u64 bad_key = 1ULL << 40;
+        fseek(file, (long)(slots_offset + i * sizeof(dlb_hash_mmap_slot)), SEEK_SET);
+        fwrite(&bad_key, sizeof(bad_key), 1, file);
+    }
+    fclose(file);
+    DLB_ASSERT(dlb_hash_mmap_open(&map, path));
+    found = 1;
+    DLB_ASSERT(!dlb_hash_mmap_search(&map, keys[0], strlen(keys[0]), &found) && !found);
+    dlb_hash_mmap_close(&map);
+
+#ifndef _WIN32
+    // Rewriting replaces the file; an existing mapping keeps the old one
+    dlb_hash_init(&table, DLB_HASH_INT, "mmap_old", 16);
+    dlb_hash_insert_int(&table, 7, (void *)1);
+    DLB_ASSERT(dlb_hash_mmap_write(&table, path));
+    DLB_ASSERT(dlb_hash_mmap_open(&map, path));
+    dlb_hash_insert_int(&table, 8, (void *)2);
+    DLB_ASSERT(dlb_hash_mmap_write(&table, path));
+    dlb_hash_free(&table);
+    DLB_ASSERT(dlb_hash_mmap_search_int(&map, 7, 0) == (void *)1 && !dlb_hash_mmap_search_int(&map, 8, 0));
+    dlb_hash_mmap_close(&map);
+    DLB_ASSERT(dlb_hash_mmap_open(&map, path));
+    DLB_ASSERT(dlb_hash_mmap_search_int(&map, 8, 0) == (void *)2);
+    dlb_hash_mmap_close(&map);
+#endif
+
+    // Garbage and truncated files aren't mistaken for a table
+    file = fopen(path, "rb");
+    fseek(file, 0, SEEK_END);
+    size_t length = (size_t)ftell(file);
+    char *bytes = (char *)dlb_malloc(length);
+    fseek(file, 0, SEEK_SET);
+    DLB_ASSERT(fread(bytes, length, 1, file) == 1);
+    fclose(file);
+    file = fopen(path, "wb");
+    fwrite(bytes, length - 1, 1, file);
+    fclose(file);
+    dlb_free(bytes);
+    DLB_ASSERT(!dlb_hash_mmap_open(&map, path));
+    file = fopen(path, "wb");
+    fputs("not a hash table", file);
+    fclose(file);
+    DLB_ASSERT(!dlb_hash_mmap_open(&map, path));
+    remove(path);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
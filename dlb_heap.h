@@ -19,6 +19,37 @@ typedef struct dlb_heap {
     dlb_heap_node *nodes;
 } dlb_heap;
 
+void dlb_heap_init(dlb_heap *heap);
+void dlb_heap_free(dlb_heap *heap);
+size_t dlb_heap_size(dlb_heap *heap);
+bool dlb_heap_empty(dlb_heap *heap);
+void dlb_heap_push(dlb_heap *heap, u32 priority, void *data);
+void *dlb_heap_peek(dlb_heap *heap);
+u32 dlb_heap_peek_priority(dlb_heap *heap);
+void *dlb_heap_pop(dlb_heap *heap);
+
+// Same as dlb_heap, but stores a fixed-size payload inline next to each
+// priority instead of a void *, so pop copies the payload out with no pointer
+// chase and callers don't need a separate allocation per element.
+typedef struct dlb_heap_inline {
+    size_t payload_size;
+    size_t stride;  // bytes per node: u32 priority + payload, 4-byte aligned
+    // Note: node 0 is reserved, and used as scratch space while sifting
+    u8 *nodes;
+} dlb_heap_inline;
+
+void dlb_heap_inline_init(dlb_heap_inline *heap, size_t payload_size);
+void dlb_heap_inline_free(dlb_heap_inline *heap);
+size_t dlb_heap_inline_size(dlb_heap_inline *heap);
+bool dlb_heap_inline_empty(dlb_heap_inline *heap);
+void dlb_heap_inline_push(dlb_heap_inline *heap, u32 priority, const void *payload);
+// Copy top payload into `payload`, returns false if empty
+bool dlb_heap_inline_peek(dlb_heap_inline *heap, void *payload);
+// Copy top payload into `payload` and remove it, returns false if empty
+bool dlb_heap_inline_pop(dlb_heap_inline *heap, void *payload);
+
+void dlb_heap_test();
+
 #endif
 //-- end of header -------------------------------------------------------------
 
@@ -34,7 +65,8 @@ typedef struct dlb_heap {
 
 void dlb_heap_init(dlb_heap *heap)
 {
-    dlb_vec_push(heap->nodes, (dlb_heap_node){ 0, 0 });
+    dlb_heap_node sentinel = { 0, 0 };
+    dlb_vec_push(heap->nodes, sentinel);
 }
 
 void dlb_heap_free(dlb_heap *heap)
@@ -106,7 +138,8 @@ void dlb_heap__sift_down(dlb_heap *heap, size_t index)
 void dlb_heap_push(dlb_heap *heap, u32 priority, void *data)
 {
     DLB_ASSERT(priority > 0);
-    dlb_vec_push(heap->nodes, (dlb_heap_node){ priority, data });
+    dlb_heap_node node = { priority, data };
+    dlb_vec_push(heap->nodes, node);
     dlb_heap__sift_up(heap, dlb_vec_len(heap->nodes) - 1);
 }
 
@@ -120,6 +153,17 @@ void *dlb_heap_peek(dlb_heap *heap)
     return data;
 }
 
+// Returns priority of the top node, or 0 if empty (pushed priorities are > 0)
+u32 dlb_heap_peek_priority(dlb_heap *heap)
+{
+    if (dlb_heap_empty(heap))
+    {
+        return 0;
+    }
+    u32 priority = heap->nodes[1].priority;
+    return priority;
+}
+
 void *dlb_heap_pop(dlb_heap *heap)
 {
     size_t last = dlb_heap_size(heap);
@@ -141,6 +185,167 @@ void *dlb_heap_pop(dlb_heap *heap)
     return data;
 }
 
+//-- dlb_heap_inline -----------------------------------------------------------
+
+#define dlb_heap_inline__node(heap, index) ((heap)->nodes + (index) * (heap)->stride)
+#define dlb_heap_inline__priority(heap, index) (*(u32 *)dlb_heap_inline__node((heap), (index)))
+
+void dlb_heap_inline_init(dlb_heap_inline *heap, size_t payload_size)
+{
+    DLB_ASSERT(payload_size);
+    heap->payload_size = payload_size;
+    heap->stride = ALIGN_UP(sizeof(u32) + payload_size, sizeof(u32));
+    heap->nodes = 0;
+    dlb_vec_alloc_size(heap->nodes, heap->stride);
+}
+
+void dlb_heap_inline_free(dlb_heap_inline *heap)
+{
+    dlb_vec_free(heap->nodes);
+}
+
+size_t dlb_heap_inline_size(dlb_heap_inline *heap)
+{
+    size_t len = dlb_vec_len(heap->nodes);
+    return len - 1;
+}
+
+bool dlb_heap_inline_empty(dlb_heap_inline *heap)
+{
+    size_t size = dlb_heap_inline_size(heap);
+    return size == 0;
+}
+
+void dlb_heap_inline_push(dlb_heap_inline *heap, u32 priority, const void *payload)
+{
+    DLB_ASSERT(priority > 0);
+    dlb_vec_alloc_size(heap->nodes, heap->stride);
+
+    // Move parents down into the hole until the new node fits, then write it
+    // once rather than swapping at every level
+    size_t index = dlb_heap_inline_size(heap);
+    size_t parent = dlb_heap__parent(index);
+    while (parent && priority > dlb_heap_inline__priority(heap, parent))
+    {
+        memcpy(dlb_heap_inline__node(heap, index), dlb_heap_inline__node(heap, parent), heap->stride);
+        index = parent;
+        parent = dlb_heap__parent(index);
+    }
+
+    u8 *node = dlb_heap_inline__node(heap, index);
+    *(u32 *)node = priority;
+    memcpy(node + sizeof(u32), payload, heap->payload_size);
+}
+
+bool dlb_heap_inline_peek(dlb_heap_inline *heap, void *payload)
+{
+    if (dlb_heap_inline_empty(heap))
+    {
+        return false;
+    }
+    memcpy(payload, dlb_heap_inline__node(heap, 1) + sizeof(u32), heap->payload_size);
+    return true;
+}
+
+bool dlb_heap_inline_pop(dlb_heap_inline *heap, void *payload)
+{
+    size_t last = dlb_heap_inline_size(heap);
+    if (!last)
+    {
+        return false;
+    }
+
+    memcpy(payload, dlb_heap_inline__node(heap, 1) + sizeof(u32), heap->payload_size);
+    if (last > 1)
+    {
+        // Sift the last node down from the root through a hole, keeping it in
+        // the reserved scratch node while children are moved up
+        u8 *scratch = dlb_heap_inline__node(heap, 0);
+        memcpy(scratch, dlb_heap_inline__node(heap, last), heap->stride);
+        u32 priority = *(u32 *)scratch;
+
+        size_t size = last;  // # of nodes + 1 after removing the last one
+        size_t index = 1;
+        for (;;)
+        {
+            size_t child = index * 2;
+            if (child >= size)
+                break;
+            if (child + 1 < size &&
+                dlb_heap_inline__priority(heap, child + 1) > dlb_heap_inline__priority(heap, child))
+                child++;
+            if (priority >= dlb_heap_inline__priority(heap, child))
+                break;
+
+            memcpy(dlb_heap_inline__node(heap, index), dlb_heap_inline__node(heap, child), heap->stride);
+            index = child;
+        }
+        memcpy(dlb_heap_inline__node(heap, index), scratch, heap->stride);
+    }
+    dlb_vec_pop(heap->nodes);
+    return true;
+}
+
 #endif
 #endif
 //-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_HEAP_TEST
+
+void dlb_heap_test()
+{
+    // Odd payload sizes, so the stride has padding and nodes aren't
+    // pointer-aligned
+    const size_t payload_sizes[] = { 1, 13 };
+    for (u32 s = 0; s < ARRAY_SIZE(payload_sizes); s++)
+    {
+        size_t payload_size = payload_sizes[s];
+        dlb_heap_inline heap;
+        dlb_heap_inline_init(&heap, payload_size);
+
+        u8 payload[13];
+        DLB_ASSERT(!dlb_heap_inline_peek(&heap, payload));
+        DLB_ASSERT(!dlb_heap_inline_pop(&heap, payload));
+
+        // Payload byte k is (priority + k), so a payload separated from its
+        // priority shows up on pop. Only 50 distinct priorities: lots of ties.
+        const u32 count = 1000;
+        u32 x = 12345;
+        for (u32 i = 0; i < count; i++)
+        {
+            x = x * 1103515245 + 12345;
+            u32 priority = (x >> 16) % 50 + 1;
+            for (size_t k = 0; k < payload_size; k++)
+            {
+                payload[k] = (u8)(priority + k);
+            }
+            dlb_heap_inline_push(&heap, priority, payload);
+        }
+        DLB_ASSERT(dlb_heap_inline_size(&heap) == count);
+
+        u32 prev = UINT32_MAX;
+        for (u32 i = 0; i < count; i++)
+        {
+            u8 peeked[13];
+            DLB_ASSERT(dlb_heap_inline_peek(&heap, peeked));
+            DLB_ASSERT(dlb_heap_inline_pop(&heap, payload));
+            DLB_ASSERT(!memcmp(peeked, payload, payload_size));
+            u32 priority = payload[0];
+            DLB_ASSERT(priority >= 1 && priority <= 50);
+            DLB_ASSERT(priority <= prev);
+            for (size_t k = 0; k < payload_size; k++)
+            {
+                DLB_ASSERT(payload[k] == (u8)(priority + k));
+            }
+            prev = priority;
+        }
+        DLB_ASSERT(dlb_heap_inline_empty(&heap));
+        DLB_ASSERT(!dlb_heap_inline_peek(&heap, payload));
+        DLB_ASSERT(!dlb_heap_inline_pop(&heap, payload));
+        dlb_heap_inline_free(&heap);
+    }
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
@@ -0,0 +1,299 @@
+#ifndef DLB_MPH_H
+#define DLB_MPH_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Minimal perfect hash for static key sets (BBHash-style), e.g. config keys,
+// opcode names or DLB_ENUM string tables: built once, never modified.
+//
+// Maps n keys to distinct indices in [0, n) and stores the values (and a copy
+// of the keys, to reject unknown ones) densely in that order. A lookup is one
+// MurmurHash3_x64_128 call, a bit test per level until the key's bit is found
+// (1.5 levels on average for gamma = 1), one rank query, and one key compare.
+#if 0
+    dlb_mph opcodes = { 0 };
+    dlb_mph_build(&opcodes, names, name_lens, (void **)handlers, count, 1.0);
+    handler = dlb_mph_search(&opcodes, name, name_len, &found);
+#endif
+//
+// How it works: level 0 is a bitset of gamma * n bits. Every key hashes to one
+// bit; bits hit by exactly one key are kept, keys that collided move on to
+// the next level, sized gamma * (# of collided keys), and so on. All levels
+// share one bitset, so rank1() of a key's bit is its index. Every level's
+// position comes from the same 128-bit hash (h0 + level * h1), seeded with
+// MurmurHash3_seed at build time.
+//
+// Space for the function itself is ~gamma * e^(1/gamma) bits per key plus ~3%
+// for the rank index: ~2.8 bits/key at gamma = 1.0, ~3.4 bits/key at
+// gamma = 2.0. Larger gamma builds faster and needs fewer levels per lookup.
+//
+// Requires DLB_MURMUR3_IMPLEMENTATION and DLB_BITSET_RANK_IMPLEMENTATION in
+// some translation unit.
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_bitset.h"
+#include "dlb_bitset_rank.h"
+#include "dlb_murmur3.h"
+
+// Each level passes ~1 - e^(-1/gamma) of its keys on; 1e9 keys need ~45 levels at
+// gamma = 1. Keys still colliding after this many are duplicates.
+#define DLB_MPH_MAX_LEVELS 64
+#define DLB_MPH_NONE UINT32_MAX
+
+typedef struct dlb_mph {
+    u32 count;
+    u32 seed;            // MurmurHash3_seed at build time, must match at lookup
+    u32 level_count;
+    u32 level_offset[DLB_MPH_MAX_LEVELS + 1];  // first bit of each level, 64-bit aligned
+    dlb_bitset bits;     // all levels back to back
+    dlb_bitset_rank rank;
+    void **values;       // count values, in index order
+    u32 *key_offsets;    // count + 1 offsets into keys, in index order
+    char *keys;
+} dlb_mph;
+
+// Build from count distinct keys, values[i] belongs to keys[i]. gamma >= 1.0
+// trades space for build and lookup speed, see above. Returns 0 (and leaves
+// mph empty) if keys has duplicates.
+int dlb_mph_build(dlb_mph *mph, const void **keys, const size_t *klens, void **values, u32 count,
+                  double gamma);
+void dlb_mph_free(dlb_mph *mph);
+// Index of key in [0, count) without checking that key is in the set; unknown
+// keys return an arbitrary index or DLB_MPH_NONE
+u32 dlb_mph_index(const dlb_mph *mph, const void *key, size_t klen);
+// Returns the value, or NULL with *found = 0 if key isn't in the set
+void *dlb_mph_search(const dlb_mph *mph, const void *key, size_t klen, int *found);
+
+void dlb_mph_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_MPH_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_MPH_IMPLEMENTATION
+#ifndef DLB_MPH_IMPL_INTERNAL
+#define DLB_MPH_IMPL_INTERNAL
+
+#include <string.h>
+
+typedef struct dlb_mph__hash {
+    u64 h[2];
+} dlb_mph__hash;
+
+static inline dlb_mph__hash dlb_mph__hash_key(const void *key, size_t klen)
+{
+    dlb_mph__hash hash;
+    MurmurHash3_x64_128(key, (int)klen, hash.h);
+    return hash;
+}
+
+// Bit for hash within a level of `bits` bits
+static inline u32 dlb_mph__position(dlb_mph__hash hash, u32 level, u32 bits)
+{
+    // Murmur's two halves are correlated, so remix every level (splitmix64
+    // finalizer) rather than trusting h0 + level * h1 alone
+    u64 x = hash.h[0] + level * hash.h[1];
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    // Multiply-shift range reduction
+    return (u32)(((x >> 32) * bits) >> 32);
+}
+
+// Bits in a level for `keys` keys, rounded to whole words
+static inline u32 dlb_mph__level_bits(u32 keys, double gamma)
+{
+    u64 bits = (u64)(keys * gamma) + 1;
+    bits = ALIGN_UP(bits, 64);
+    DLB_ASSERT(bits < UINT32_MAX);
+    return (u32)bits;
+}
+
+int dlb_mph_build(dlb_mph *mph, const void **keys, const size_t *klens, void **values, u32 count,
+                  double gamma)
+{
+    DLB_ASSERT(gamma >= 1.0);
+    dlb_memset(mph, 0, sizeof(*mph));
+    mph->count = count;
+    mph->seed = MurmurHash3_seed;
+
+    dlb_mph__hash *hashes = (dlb_mph__hash *)dlb_malloc(MAX(count, 1) * sizeof(*hashes));
+    u32 *remaining = (u32 *)dlb_malloc(MAX(count, 1) * sizeof(*remaining));
+    u32 *positions = (u32 *)dlb_malloc(MAX(count, 1) * sizeof(*positions));
+    for (u32 i = 0; i < count; i++) {
+        hashes[i] = dlb_mph__hash_key(keys[i], klens[i]);
+        remaining[i] = i;
+    }
+
+    u32 remaining_count = count;
+    dlb_bitset collided = { 0 };
+    u32 offset = 0;
+    u32 level = 0;
+    for (; remaining_count && level < DLB_MPH_MAX_LEVELS; level++) {
+        u32 bits = dlb_mph__level_bits(remaining_count, gamma);
+        mph->level_offset[level] = offset;
+        dlb_bitset_reserve(&mph->bits, offset + bits);
+        dlb_bitset_reserve(&collided, bits);
+        dlb_bitset_clear_all(&collided);
+
+        // Mark each key's bit, remember the bits hit more than once
+        for (u32 i = 0; i < remaining_count; i++) {
+            u32 pos = dlb_mph__position(hashes[remaining[i]], level, bits);
+            if (dlb_bitset_get(&mph->bits, offset + pos)) {
+                dlb_bitset_set(&collided, pos);
+            } else {
+                dlb_bitset_set(&mph->bits, offset + pos);
+            }
+        }
+        u64 *level_words = mph->bits.bitmaps + (offset >> 6);
+        for (u32 w = 0; w < (bits >> 6); w++) {
+            level_words[w] &= ~collided.bitmaps[w];
+        }
+
+        // Keys that got a bit to themselves are placed, the rest go down a level
+        u32 next_count = 0;
+        for (u32 i = 0; i < remaining_count; i++) {
+            u32 key = remaining[i];
+            u32 pos = dlb_mph__position(hashes[key], level, bits);
+            if (dlb_bitset_get(&collided, pos)) {
+                remaining[next_count++] = key;
+            } else {
+                positions[key] = offset + pos;
+            }
+        }
+        remaining_count = next_count;
+        offset += bits;
+    }
+    mph->level_count = level;
+    mph->level_offset[level] = offset;
+    dlb_bitset_free(&collided);
+    dlb_free(remaining);
+    dlb_free(hashes);
+
+    if (remaining_count) {
+        // Identical 128-bit hashes, i.e. duplicate keys
+        dlb_free(positions);
+        dlb_mph_free(mph);
+        return 0;
+    }
+
+    dlb_bitset_rank_build(&mph->rank, &mph->bits);
+    DLB_ASSERT(mph->rank.ones == count);
+
+    // Lay values and keys out in index order
+    mph->values = (void **)dlb_malloc(MAX(count, 1) * sizeof(*mph->values));
+    mph->key_offsets = (u32 *)dlb_calloc((size_t)count + 1, sizeof(*mph->key_offsets));
+    for (u32 i = 0; i < count; i++) {
+        u32 index = dlb_bitset_rank1(&mph->rank, positions[i]);
+        positions[i] = index;
+        mph->values[index] = values ? values[i] : 0;
+        DLB_ASSERT(klens[i] <= UINT32_MAX);
+        mph->key_offsets[index + 1] = (u32)klens[i];
+    }
+    for (u32 i = 0; i < count; i++) {
+        DLB_ASSERT((u64)mph->key_offsets[i] + mph->key_offsets[i + 1] <= UINT32_MAX);
+        mph->key_offsets[i + 1] += mph->key_offsets[i];
+    }
+    mph->keys = (char *)dlb_malloc(MAX(mph->key_offsets[count], 1));
+    for (u32 i = 0; i < count; i++) {
+        memcpy(mph->keys + mph->key_offsets[positions[i]], keys[i], klens[i]);
+    }
+    dlb_free(positions);
+    return 1;
+}
+
+void dlb_mph_free(dlb_mph *mph)
+{
+    dlb_bitset_rank_free(&mph->rank);
+    dlb_bitset_free(&mph->bits);
+    dlb_free(mph->values);
+    dlb_free(mph->key_offsets);
+    dlb_free(mph->keys);
+    dlb_memset(mph, 0, sizeof(*mph));
+}
+
+u32 dlb_mph_index(const dlb_mph *mph, const void *key, size_t klen)
+{
+    DLB_ASSERT(MurmurHash3_seed == mph->seed);
+    dlb_mph__hash hash = dlb_mph__hash_key(key, klen);
+    for (u32 level = 0; level < mph->level_count; level++) {
+        u32 offset = mph->level_offset[level];
+        u32 bits = mph->level_offset[level + 1] - offset;
+        u32 pos = offset + dlb_mph__position(hash, level, bits);
+        if (dlb_bitset_get(&mph->bits, pos)) {
+            return dlb_bitset_rank1(&mph->rank, pos);
+        }
+    }
+    return DLB_MPH_NONE;
+}
+
+void *dlb_mph_search(const dlb_mph *mph, const void *key, size_t klen, int *found)
+{
+    u32 index = dlb_mph_index(mph, key, klen);
+    int hit = index != DLB_MPH_NONE && mph->key_offsets[index + 1] - mph->key_offsets[index] == klen &&
+              !memcmp(mph->keys + mph->key_offsets[index], key, klen);
+    if (found) *found = hit;
+    return hit ? mph->values[index] : NULL;
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_MPH_TEST
+
+#include <stdio.h>
+
+void dlb_mph_test()
+{
+    const u32 count = 10000;
+    static char names[10000][16];
+    static const void *keys[10000];
+    static size_t klens[10000];
+    static void *values[10000];
+    for (u32 i = 0; i < count; i++) {
+        snprintf(names[i], sizeof(names[i]), "key%u", i);
+        keys[i] = names[i];
+        klens[i] = strlen(names[i]);
+        values[i] = (void *)(uintptr_t)(i + 1);
+    }
+
+    for (u32 g = 1; g <= 2; g++) {
+        dlb_mph mph = { 0 };
+        DLB_ASSERT(dlb_mph_build(&mph, keys, klens, values, count, (double)g));
+        // Every key gets its own index and its own value back
+        dlb_bitset seen = { 0 };
+        for (u32 i = 0; i < count; i++) {
+            u32 index = dlb_mph_index(&mph, keys[i], klens[i]);
+            DLB_ASSERT(index < count);
+            DLB_ASSERT(!dlb_bitset_get(&seen, index));
+            dlb_bitset_set(&seen, index);
+            int found = 0;
+            DLB_ASSERT(dlb_mph_search(&mph, keys[i], klens[i], &found) == values[i] && found);
+        }
+        dlb_bitset_free(&seen);
+        // ~gamma * e^(1/gamma) bits per key
+        DLB_ASSERT(mph.level_offset[mph.level_count] < count * 4 * g);
+        int found = 1;
+        DLB_ASSERT(!dlb_mph_search(&mph, "missing", 7, &found) && !found);
+        dlb_mph_free(&mph);
+    }
+
+    // Duplicates can't be separated
+    keys[1] = keys[0];
+    klens[1] = klens[0];
+    dlb_mph mph = { 0 };
+    DLB_ASSERT(!dlb_mph_build(&mph, keys, klens, values, count, 1.0));
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
@@ -0,0 +1,257 @@
+#ifndef DLB_MULTIQUEUE_H
+#define DLB_MULTIQUEUE_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Concurrent relaxed priority queue (MultiQueue, Rihani/Sanders/Dementiev).
+//
+// Made of c * threads independent dlb_heaps, each behind its own spinlock.
+// Push inserts into a random heap. Pop samples two random heaps and pops from
+// the one with the higher top priority. Pops are not strictly ordered; the
+// expected rank error is O(c * threads), but throughput scales with the # of
+// threads because threads rarely touch the same heap.
+//
+// Each thread passes its own dlb_rand32_t, seeded with a unique sequence so
+// threads don't pick the same heaps in lock step:
+#if 0
+    dlb_rand32_t rng;
+    dlb_rand32_seed_r(&rng, time(0), thread_index);
+    dlb_multiqueue_push(&queue, &rng, job->priority, job);
+    Job *next = (Job *)dlb_multiqueue_pop(&queue, &rng);
+#endif
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_heap.h"
+#include "dlb_rand.h"
+#include <atomic>
+
+// Own cache line per heap so threads hammering neighboring heaps don't contend
+typedef struct alignas(64) dlb_multiqueue_lane {
+    std::atomic<bool> locked;
+    std::atomic<u32> top;  // cached top priority for lock-free sampling, 0 = empty
+    dlb_heap heap;
+} dlb_multiqueue_lane;
+
+typedef struct dlb_multiqueue {
+    u32 lane_count;
+    dlb_multiqueue_lane *lanes;
+} dlb_multiqueue;
+
+// threads: # of threads that will access the queue
+// c: heaps per thread, higher = less contention but larger rank error (2 is typical)
+void dlb_multiqueue_init(dlb_multiqueue *queue, u32 threads, u32 c);
+void dlb_multiqueue_free(dlb_multiqueue *queue);
+// priority must be > 0, higher priorities are popped first. data must not be
+// NULL, that's pop's "empty" result.
+void dlb_multiqueue_push(dlb_multiqueue *queue, dlb_rand32_t *rng, u32 priority, void *data);
+// Returns NULL only if every heap was empty when checked
+void *dlb_multiqueue_pop(dlb_multiqueue *queue, dlb_rand32_t *rng);
+
+void dlb_multiqueue_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_MULTIQUEUE_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_MULTIQUEUE_IMPLEMENTATION
+#ifndef DLB_MULTIQUEUE_IMPL_INTERNAL
+#define DLB_MULTIQUEUE_IMPL_INTERNAL
+
+// # of failed two-choice samples before pop falls back to scanning every heap
+#define DLB_MULTIQUEUE_POP_ATTEMPTS 4
+
+void dlb_multiqueue_init(dlb_multiqueue *queue, u32 threads, u32 c)
+{
+    DLB_ASSERT(threads);
+    DLB_ASSERT(c);
+    // Need at least 2 heaps for two-choice sampling
+    queue->lane_count = MAX(threads * c, 2);
+    queue->lanes = new dlb_multiqueue_lane[queue->lane_count]();
+    for (u32 i = 0; i < queue->lane_count; i++) {
+        dlb_heap_init(&queue->lanes[i].heap);
+    }
+}
+
+void dlb_multiqueue_free(dlb_multiqueue *queue)
+{
+    for (u32 i = 0; i < queue->lane_count; i++) {
+        dlb_heap_free(&queue->lanes[i].heap);
+    }
+    delete[] queue->lanes;
+    queue->lanes = 0;
+    queue->lane_count = 0;
+}
+
+static inline bool dlb_multiqueue__try_lock(dlb_multiqueue_lane *lane)
+{
+    // Test before exchange to avoid bouncing the cache line while it's held
+    return !lane->locked.load(std::memory_order_relaxed) &&
+           !lane->locked.exchange(true, std::memory_order_acquire);
+}
+
+static inline void dlb_multiqueue__unlock(dlb_multiqueue_lane *lane)
+{
+    lane->top.store(dlb_heap_peek_priority(&lane->heap), std::memory_order_relaxed);
+    lane->locked.store(false, std::memory_order_release);
+}
+
+static inline u32 dlb_multiqueue__random_lane(dlb_multiqueue *queue, dlb_rand32_t *rng)
+{
+    return dlb_rand32u_range_r(rng, 0, queue->lane_count - 1);
+}
+
+void dlb_multiqueue_push(dlb_multiqueue *queue, dlb_rand32_t *rng, u32 priority, void *data)
+{
+    DLB_ASSERT(priority > 0);
+    DLB_ASSERT(data);
+    for (;;) {
+        dlb_multiqueue_lane *lane = &queue->lanes[dlb_multiqueue__random_lane(queue, rng)];
+        if (dlb_multiqueue__try_lock(lane)) {
+            dlb_heap_push(&lane->heap, priority, data);
+            dlb_multiqueue__unlock(lane);
+            return;
+        }
+    }
+}
+
+static bool dlb_multiqueue__pop_lane(dlb_multiqueue_lane *lane, void **data)
+{
+    if (!dlb_multiqueue__try_lock(lane)) {
+        return false;
+    }
+    // Cached top may be stale, re-check under the lock
+    bool popped = !dlb_heap_empty(&lane->heap);
+    if (popped) {
+        *data = dlb_heap_pop(&lane->heap);
+    }
+    dlb_multiqueue__unlock(lane);
+    return popped;
+}
+
+void *dlb_multiqueue_pop(dlb_multiqueue *queue, dlb_rand32_t *rng)
+{
+    void *data = 0;
+    u32 misses = 0;
+    for (;;) {
+        if (misses < DLB_MULTIQUEUE_POP_ATTEMPTS) {
+            u32 a = dlb_multiqueue__random_lane(queue, rng);
+            u32 b = dlb_multiqueue__random_lane(queue, rng);
+            u32 a_top = queue->lanes[a].top.load(std::memory_order_relaxed);
+            u32 b_top = queue->lanes[b].top.load(std::memory_order_relaxed);
+            dlb_multiqueue_lane *best = &queue->lanes[a_top >= b_top ? a : b];
+            if (!MAX(a_top, b_top)) {
+                misses++;
+                continue;
+            }
+            if (dlb_multiqueue__pop_lane(best, &data)) {
+                return data;
+            }
+            continue;
+        }
+
+        // Samples keep coming up empty; queue may be (nearly) empty. Check
+        // every heap so callers can rely on NULL meaning "nothing to do".
+        bool contended = false;
+        for (u32 i = 0; i < queue->lane_count; i++) {
+            dlb_multiqueue_lane *lane = &queue->lanes[i];
+            if (!lane->top.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            if (dlb_multiqueue__pop_lane(lane, &data)) {
+                return data;
+            }
+            contended = true;
+        }
+        if (!contended) {
+            return 0;
+        }
+        misses = 0;
+    }
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_MULTIQUEUE_TEST
+
+#include <thread>
+
+void dlb_multiqueue_test()
+{
+    const u32 producers = 4;
+    const u32 consumers = 4;
+    const u32 per_producer = 20000;
+    const u32 total = producers * per_producer;
+    dlb_multiqueue queue;
+    dlb_multiqueue_init(&queue, producers + consumers, 2);
+
+    // Item i is pushed once with data i + 1; every pop marks it, so a lost or
+    // duplicated item shows up as a count other than 1
+    std::atomic<u8> *popped = new std::atomic<u8>[total]();
+    std::atomic<u32> producers_done{ 0 };
+    std::thread workers[producers + consumers];
+    for (u32 t = 0; t < producers; t++) {
+        workers[t] = std::thread([&queue, t, per_producer]() {
+            dlb_rand32_t rng;
+            dlb_rand32_seed_r(&rng, 42, t);
+            for (u32 i = 0; i < per_producer; i++) {
+                u32 item = t * per_producer + i;
+                // Plenty of duplicate priorities
+                u32 priority = dlb_rand32u_range_r(&rng, 1, 100);
+                dlb_multiqueue_push(&queue, &rng, priority, (void *)(size_t)(item + 1));
+            }
+        });
+    }
+    for (u32 t = producers; t < producers + consumers; t++) {
+        workers[t] = std::thread([&queue, &producers_done, popped, t, producers]() {
+            dlb_rand32_t rng;
+            dlb_rand32_seed_r(&rng, 42, t);
+            for (;;) {
+                // Read before popping: NULL after every producer finished
+                // means the queue really was drained
+                bool done = producers_done.load() == producers;
+                void *data = dlb_multiqueue_pop(&queue, &rng);
+                if (!data) {
+                    if (done) break;
+                    continue;
+                }
+                popped[(size_t)data - 1].fetch_add(1);
+            }
+        });
+    }
+    for (u32 t = 0; t < producers; t++) {
+        workers[t].join();
+        producers_done.fetch_add(1);
+    }
+    for (u32 t = producers; t < producers + consumers; t++) {
+        workers[t].join();
+    }
+
+    for (u32 i = 0; i < total; i++) {
+        DLB_ASSERT(popped[i].load() == 1);
+    }
+    dlb_rand32_t rng;
+    dlb_rand32_seed_r(&rng, 42, producers + consumers);
+    DLB_ASSERT(!dlb_multiqueue_pop(&queue, &rng));
+
+    // A lone item is found by the fallback scan even when sampling misses it
+    dlb_multiqueue_push(&queue, &rng, 7, (void *)1);
+    DLB_ASSERT(dlb_multiqueue_pop(&queue, &rng) == (void *)1);
+    DLB_ASSERT(!dlb_multiqueue_pop(&queue, &rng));
+
+    delete[] popped;
+    dlb_multiqueue_free(&queue);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
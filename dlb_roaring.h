@@ -0,0 +1,1002 @@
+#ifndef DLB_ROARING_H
+#define DLB_ROARING_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Compressed bitmap for sparse sets of u32 (Roaring-style, Chambi/Lemire et al).
+//
+// Values are split into 16-bit chunks keyed by their high 16 bits. Each chunk
+// is stored in whichever container is smallest for its contents:
+//
+//   array:  sorted u16 values, used while cardinality <= 4096 (<= 8 KB)
+//   bitmap: 65536-bit dlb_bitset, used for denser chunks (always 8 KB)
+//   run:    sorted [start, start + length] ranges, see dlb_roaring_run_optimize
+//
+// Complements dlb_bitset, which is better for dense sets over small ranges.
+// Bitmap containers use dlb_bitset, so DLB_BITSET_IMPLEMENTATION must be
+// defined in the same translation unit as DLB_ROARING_IMPLEMENTATION.
+//
+// NOTE: dlb_roaring_serialize uses its own simple format, it is not the
+// portable RoaringFormatSpec used by CRoaring et al.
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_vector.h"
+#include "dlb_bitset.h"
+
+#define DLB_ROARING_ARRAY_MAX 4096
+
+typedef enum dlb_roaring_type {
+    DLB_ROARING_ARRAY,
+    DLB_ROARING_BITMAP,
+    DLB_ROARING_RUN
+} dlb_roaring_type;
+
+typedef struct dlb_roaring_run {
+    u16 start;
+    u16 length;  // run covers [start, start + length]
+} dlb_roaring_run;
+
+typedef struct dlb_roaring_container {
+    u16 key;          // high 16 bits of every value in this container
+    u8 type;          // dlb_roaring_type
+    u32 cardinality;  // # of values, 1 - 65536
+    union {
+        u16 *array;             // dlb_vec, sorted
+        dlb_roaring_run *runs;  // dlb_vec, sorted and non-adjacent
+        dlb_bitset bitmap;      // 65536 bits
+    };
+} dlb_roaring_container;
+
+typedef struct dlb_roaring {
+    dlb_roaring_container *containers;  // dlb_vec, sorted by key
+} dlb_roaring;
+
+void dlb_roaring_free(dlb_roaring *roaring);
+void dlb_roaring_clear(dlb_roaring *roaring);
+// Returns 1 if value was added, 0 if it was already present
+int dlb_roaring_add(dlb_roaring *roaring, u32 value);
+// Returns 1 if value was removed, 0 if it wasn't present
+int dlb_roaring_remove(dlb_roaring *roaring, u32 value);
+bool dlb_roaring_contains(const dlb_roaring *roaring, u32 value);
+u64 dlb_roaring_cardinality(const dlb_roaring *roaring);
+// Convert containers to run containers wherever that is smaller
+void dlb_roaring_run_optimize(dlb_roaring *roaring);
+
+// dst = a op b. dst must not alias a or b, its previous contents are freed.
+void dlb_roaring_and(dlb_roaring *dst, const dlb_roaring *a, const dlb_roaring *b);
+void dlb_roaring_or(dlb_roaring *dst, const dlb_roaring *a, const dlb_roaring *b);
+void dlb_roaring_andnot(dlb_roaring *dst, const dlb_roaring *a, const dlb_roaring *b);  // a & ~b
+
+// Append serialized bitmap to `buf` (dlb_vec of u8)
+void dlb_roaring_serialize(const dlb_roaring *roaring, u8 **buf);
+// Replace contents of roaring with serialized data, returns false if the data
+// is truncated or malformed (roaring is left empty)
+bool dlb_roaring_deserialize(dlb_roaring *roaring, const void *data, size_t size);
+
+void dlb_roaring_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_ROARING_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_ROARING_IMPLEMENTATION
+#ifndef DLB_ROARING_IMPL_INTERNAL
+#define DLB_ROARING_IMPL_INTERNAL
+
+#include <stddef.h>
+#include <string.h>
+
+#define DLB_ROARING__BITS 65536
+#define DLB_ROARING__MAGIC 0x52424C44  // "DLBR"
+
+typedef enum dlb_roaring__op {
+    DLB_ROARING__AND,
+    DLB_ROARING__OR,
+    DLB_ROARING__ANDNOT
+} dlb_roaring__op;
+
+//-- containers ----------------------------------------------------------------
+
+static void dlb_roaring__container_free(dlb_roaring_container *c)
+{
+    switch (c->type) {
+        case DLB_ROARING_ARRAY:  dlb_vec_free(c->array); break;
+        case DLB_ROARING_RUN:    dlb_vec_free(c->runs); break;
+        case DLB_ROARING_BITMAP: dlb_bitset_free(&c->bitmap); break;
+        default: DLB_ASSERT(0);
+    }
+    c->cardinality = 0;
+}
+
+static void dlb_roaring__container_copy(dlb_roaring_container *dst, const dlb_roaring_container *src)
+{
+    *dst = *src;
+    switch (src->type) {
+        case DLB_ROARING_ARRAY: {
+            dst->array = 0;
+            dlb_vec_alloc_count(dst->array, dlb_vec_len(src->array));
+            memcpy(dst->array, src->array, dlb_vec_len(src->array) * sizeof(*src->array));
+            break;
+        } case DLB_ROARING_RUN: {
+            dst->runs = 0;
+            dlb_vec_alloc_count(dst->runs, dlb_vec_len(src->runs));
+            memcpy(dst->runs, src->runs, dlb_vec_len(src->runs) * sizeof(*src->runs));
+            break;
+        } case DLB_ROARING_BITMAP: {
+            dlb_memset(&dst->bitmap, 0, sizeof(dst->bitmap));
+            dlb_bitset_or_into(&dst->bitmap, &src->bitmap, &src->bitmap);
+            break;
+        } default: {
+            DLB_ASSERT(0);
+        }
+    }
+}
+
+// Index of first element >= value
+static size_t dlb_roaring__array_lower_bound(const u16 *array, u16 value)
+{
+    size_t lo = 0;
+    size_t hi = dlb_vec_len(array);
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (array[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Index of last run with start <= value, or -1 if none
+static ptrdiff_t dlb_roaring__run_find(const dlb_roaring_run *runs, u16 value)
+{
+    ptrdiff_t lo = 0;
+    ptrdiff_t hi = (ptrdiff_t)dlb_vec_len(runs) - 1;
+    while (lo <= hi) {
+        ptrdiff_t mid = (lo + hi) / 2;
+        if (runs[mid].start <= value) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return hi;
+}
+
+static bool dlb_roaring__container_contains(const dlb_roaring_container *c, u16 value)
+{
+    switch (c->type) {
+        case DLB_ROARING_ARRAY: {
+            size_t i = dlb_roaring__array_lower_bound(c->array, value);
+            return i < dlb_vec_len(c->array) && c->array[i] == value;
+        } case DLB_ROARING_BITMAP: {
+            return dlb_bitset_get(&c->bitmap, value);
+        } case DLB_ROARING_RUN: {
+            ptrdiff_t i = dlb_roaring__run_find(c->runs, value);
+            return i >= 0 && value <= (u32)c->runs[i].start + c->runs[i].length;
+        } default: {
+            DLB_ASSERT(0);
+            return false;
+        }
+    }
+}
+
+// Set bits [first, last] a word at a time
+static void dlb_roaring__set_range(dlb_bitset *bits, u32 first, u32 last)
+{
+    DLB_ASSERT(first <= last && last < DLB_ROARING__BITS);
+    u32 first_word = first >> 6;
+    u32 last_word = last >> 6;
+    u64 first_mask = ~(u64)0 << (first & 63);
+    u64 last_mask = ~(u64)0 >> (63 - (last & 63));
+    if (first_word == last_word) {
+        bits->bitmaps[first_word] |= first_mask & last_mask;
+        return;
+    }
+    bits->bitmaps[first_word] |= first_mask;
+    for (u32 w = first_word + 1; w < last_word; w++) {
+        bits->bitmaps[w] = ~(u64)0;
+    }
+    bits->bitmaps[last_word] |= last_mask;
+}
+
+// Expand any container into a 65536-bit bitset
+static void dlb_roaring__container_to_bitset(const dlb_roaring_container *c, dlb_bitset *bits)
+{
+    dlb_bitset_reserve(bits, DLB_ROARING__BITS);
+    dlb_bitset_clear_all(bits);
+    switch (c->type) {
+        case DLB_ROARING_ARRAY: {
+            for (size_t i = 0; i < dlb_vec_len(c->array); i++) {
+                dlb_bitset_set(bits, c->array[i]);
+            }
+            break;
+        } case DLB_ROARING_BITMAP: {
+            memcpy(bits->bitmaps, c->bitmap.bitmaps, (size_t)c->bitmap.words * sizeof(u64));
+            break;
+        } case DLB_ROARING_RUN: {
+            for (size_t i = 0; i < dlb_vec_len(c->runs); i++) {
+                dlb_roaring__set_range(bits, c->runs[i].start, (u32)c->runs[i].start + c->runs[i].length);
+            }
+            break;
+        } default: {
+            DLB_ASSERT(0);
+        }
+    }
+}
+
+// Take ownership of a 65536-bit bitset and store it as an array or bitmap
+// container, whichever is smaller
+static void dlb_roaring__container_from_bitset(dlb_roaring_container *c, dlb_bitset *bits, u32 cardinality)
+{
+    c->cardinality = cardinality;
+    if (cardinality > DLB_ROARING_ARRAY_MAX) {
+        c->type = DLB_ROARING_BITMAP;
+        c->bitmap = *bits;
+        return;
+    }
+
+    c->type = DLB_ROARING_ARRAY;
+    c->array = 0;
+    dlb_vec_reserve(c->array, cardinality);
+    u32 index;
+    dlb_bitset_iter it = dlb_bitset_iter_begin(bits);
+    while (dlb_bitset_iter_next(&it, &index)) {
+        dlb_vec_push(c->array, (u16)index);
+    }
+    dlb_bitset_free(bits);
+}
+
+// Convert a run container back to array or bitmap
+static void dlb_roaring__container_unrun(dlb_roaring_container *c)
+{
+    DLB_ASSERT(c->type == DLB_ROARING_RUN);
+    dlb_bitset bits = { 0 };
+    dlb_roaring__container_to_bitset(c, &bits);
+    dlb_vec_free(c->runs);
+    dlb_roaring__container_from_bitset(c, &bits, c->cardinality);
+}
+
+static bool dlb_roaring__container_add(dlb_roaring_container *c, u16 value)
+{
+    switch (c->type) {
+        case DLB_ROARING_ARRAY: {
+            size_t i = dlb_roaring__array_lower_bound(c->array, value);
+            size_t len = dlb_vec_len(c->array);
+            if (i < len && c->array[i] == value) {
+                return false;
+            }
+            if (len == DLB_ROARING_ARRAY_MAX) {
+                dlb_bitset bits = { 0 };
+                dlb_roaring__container_to_bitset(c, &bits);
+                dlb_vec_free(c->array);
+                c->type = DLB_ROARING_BITMAP;
+                c->bitmap = bits;
+                dlb_bitset_set(&c->bitmap, value);
+                break;
+            }
+            dlb_vec_alloc(c->array);
+            memmove(c->array + i + 1, c->array + i, (len - i) * sizeof(*c->array));
+            c->array[i] = value;
+            break;
+        } case DLB_ROARING_BITMAP: {
+            if (dlb_bitset_get(&c->bitmap, value)) {
+                return false;
+            }
+            dlb_bitset_set(&c->bitmap, value);
+            break;
+        } case DLB_ROARING_RUN: {
+            ptrdiff_t i = dlb_roaring__run_find(c->runs, value);
+            size_t len = dlb_vec_len(c->runs);
+            bool extends_prev = false;
+            if (i >= 0) {
+                u32 end = (u32)c->runs[i].start + c->runs[i].length;
+                if (value <= end) {
+                    return false;
+                }
+                extends_prev = value == end + 1;
+            }
+            bool extends_next = (size_t)(i + 1) < len && (u32)value + 1 == c->runs[i + 1].start;
+
+            if (extends_prev && extends_next) {
+                // Fill the gap between two runs
+                c->runs[i].length += c->runs[i + 1].length + 2;
+                memmove(c->runs + i + 1, c->runs + i + 2, (len - i - 2) * sizeof(*c->runs));
+                dlb_vec_pop(c->runs);
+            } else if (extends_prev) {
+                c->runs[i].length++;
+            } else if (extends_next) {
+                c->runs[i + 1].start--;
+                c->runs[i + 1].length++;
+            } else {
+                dlb_roaring_run run = { value, 0 };
+                dlb_vec_alloc(c->runs);
+                memmove(c->runs + i + 2, c->runs + i + 1, (len - i - 1) * sizeof(*c->runs));
+                c->runs[i + 1] = run;
+            }
+            break;
+        } default: {
+            DLB_ASSERT(0);
+        }
+    }
+    c->cardinality++;
+
+    // Lots of isolated values added to a run container, switch back
+    if (c->type == DLB_ROARING_RUN && dlb_vec_len(c->runs) * 2 > MIN(c->cardinality, DLB_ROARING_ARRAY_MAX)) {
+        dlb_roaring__container_unrun(c);
+    }
+    return true;
+}
+
+static bool dlb_roaring__container_remove(dlb_roaring_container *c, u16 value)
+{
+    switch (c->type) {
+        case DLB_ROARING_ARRAY: {
+            size_t i = dlb_roaring__array_lower_bound(c->array, value);
+            size_t len = dlb_vec_len(c->array);
+            if (i == len || c->array[i] != value) {
+                return false;
+            }
+            memmove(c->array + i, c->array + i + 1, (len - i - 1) * sizeof(*c->array));
+            dlb_vec_pop(c->array);
+            break;
+        } case DLB_ROARING_BITMAP: {
+            if (!dlb_bitset_get(&c->bitmap, value)) {
+                return false;
+            }
+            dlb_bitset_unset(&c->bitmap, value);
+            if (c->cardinality - 1 == DLB_ROARING_ARRAY_MAX) {
+                dlb_bitset bits = c->bitmap;
+                dlb_roaring__container_from_bitset(c, &bits, c->cardinality - 1);
+                return true;
+            }
+            break;
+        } case DLB_ROARING_RUN: {
+            ptrdiff_t i = dlb_roaring__run_find(c->runs, value);
+            if (i < 0) {
+                return false;
+            }
+            dlb_roaring_run *run = &c->runs[i];
+            u32 end = (u32)run->start + run->length;
+            if (value > end) {
+                return false;
+            }
+            size_t len = dlb_vec_len(c->runs);
+            if (!run->length) {
+                memmove(c->runs + i, c->runs + i + 1, (len - i - 1) * sizeof(*c->runs));
+                dlb_vec_pop(c->runs);
+            } else if (value == run->start) {
+                run->start++;
+                run->length--;
+            } else if (value == end) {
+                run->length--;
+            } else {
+                // Split run in two
+                dlb_roaring_run tail = { (u16)(value + 1), (u16)(end - value - 1) };
+                run->length = (u16)(value - run->start - 1);
+                dlb_vec_alloc(c->runs);
+                memmove(c->runs + i + 2, c->runs + i + 1, (len - i - 1) * sizeof(*c->runs));
+                c->runs[i + 1] = tail;
+            }
+            break;
+        } default: {
+            DLB_ASSERT(0);
+        }
+    }
+    c->cardinality--;
+    return true;
+}
+
+// # of runs needed to represent the container
+static size_t dlb_roaring__container_run_count(const dlb_roaring_container *c)
+{
+    size_t runs = 0;
+    switch (c->type) {
+        case DLB_ROARING_ARRAY: {
+            for (size_t i = 0; i < dlb_vec_len(c->array); i++) {
+                runs += !i || c->array[i] != c->array[i - 1] + 1;
+            }
+            break;
+        } case DLB_ROARING_BITMAP: {
+            // A run starts at every set bit whose predecessor is clear
+            u64 carry = 0;
+            for (u32 i = 0; i < c->bitmap.words; i++) {
+                u64 word = c->bitmap.bitmaps[i];
+                runs += dlb_popcount64(word & ~((word << 1) | carry));
+                carry = word >> 63;
+            }
+            break;
+        } case DLB_ROARING_RUN: {
+            runs = dlb_vec_len(c->runs);
+            break;
+        } default: {
+            DLB_ASSERT(0);
+        }
+    }
+    return runs;
+}
+
+static size_t dlb_roaring__container_bytes(const dlb_roaring_container *c)
+{
+    switch (c->type) {
+        case DLB_ROARING_ARRAY:  return dlb_vec_len(c->array) * sizeof(u16);
+        case DLB_ROARING_BITMAP: return DLB_ROARING__BITS / 8;
+        case DLB_ROARING_RUN:    return dlb_vec_len(c->runs) * sizeof(dlb_roaring_run);
+        default: DLB_ASSERT(0); return 0;
+    }
+}
+
+static void dlb_roaring__container_to_runs(dlb_roaring_container *c)
+{
+    dlb_roaring_run *runs = 0;
+    u32 value;
+    dlb_bitset bits = { 0 };
+    dlb_roaring__container_to_bitset(c, &bits);
+    dlb_bitset_iter it = dlb_bitset_iter_begin(&bits);
+    while (dlb_bitset_iter_next(&it, &value)) {
+        dlb_roaring_run *last = dlb_vec_last(runs);
+        if (last && (u32)last->start + last->length + 1 == value) {
+            last->length++;
+        } else {
+            dlb_roaring_run run = { (u16)value, 0 };
+            dlb_vec_push(runs, run);
+        }
+    }
+    dlb_bitset_free(&bits);
+
+    u32 cardinality = c->cardinality;
+    dlb_roaring__container_free(c);
+    c->type = DLB_ROARING_RUN;
+    c->cardinality = cardinality;
+    c->runs = runs;
+}
+
+// out = a op b, out->cardinality is 0 if the result is empty
+static void dlb_roaring__container_op(dlb_roaring__op op, dlb_roaring_container *out,
+    const dlb_roaring_container *a, const dlb_roaring_container *b)
+{
+    out->key = a->key;
+    out->cardinality = 0;
+
+    if (a->type == DLB_ROARING_ARRAY && b->type == DLB_ROARING_ARRAY) {
+        // Merge two sorted arrays
+        u16 *result = 0;
+        size_t a_len = dlb_vec_len(a->array);
+        size_t b_len = dlb_vec_len(b->array);
+        dlb_vec_reserve(result, op == DLB_ROARING__OR ? a_len + b_len : a_len);
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a_len && j < b_len) {
+            u16 x = a->array[i];
+            u16 y = b->array[j];
+            if (x < y) {
+                if (op != DLB_ROARING__AND) dlb_vec_push(result, x);
+                i++;
+            } else if (y < x) {
+                if (op == DLB_ROARING__OR) dlb_vec_push(result, y);
+                j++;
+            } else {
+                if (op != DLB_ROARING__ANDNOT) dlb_vec_push(result, x);
+                i++;
+                j++;
+            }
+        }
+        if (op != DLB_ROARING__AND) {
+            for (; i < a_len; i++) dlb_vec_push(result, a->array[i]);
+        }
+        if (op == DLB_ROARING__OR) {
+            for (; j < b_len; j++) dlb_vec_push(result, b->array[j]);
+        }
+
+        out->type = DLB_ROARING_ARRAY;
+        out->array = result;
+        out->cardinality = (u32)dlb_vec_len(result);
+        if (out->cardinality > DLB_ROARING_ARRAY_MAX) {
+            dlb_bitset bits = { 0 };
+            dlb_roaring__container_to_bitset(out, &bits);
+            dlb_vec_free(out->array);
+            dlb_roaring__container_from_bitset(out, &bits, out->cardinality);
+        }
+        return;
+    }
+
+    // Small array against anything: probe the other container per value
+    const dlb_roaring_container *filter = 0;
+    const dlb_roaring_container *other = 0;
+    if (op == DLB_ROARING__AND && a->type == DLB_ROARING_ARRAY) {
+        filter = a; other = b;
+    } else if (op == DLB_ROARING__AND && b->type == DLB_ROARING_ARRAY) {
+        filter = b; other = a;
+    } else if (op == DLB_ROARING__ANDNOT && a->type == DLB_ROARING_ARRAY) {
+        filter = a; other = b;
+    }
+    if (filter) {
+        bool keep_if = op == DLB_ROARING__AND;
+        u16 *result = 0;
+        for (size_t i = 0; i < dlb_vec_len(filter->array); i++) {
+            u16 value = filter->array[i];
+            if (dlb_roaring__container_contains(other, value) == keep_if) {
+                dlb_vec_push(result, value);
+            }
+        }
+        out->type = DLB_ROARING_ARRAY;
+        out->array = result;
+        out->cardinality = (u32)dlb_vec_len(result);
+        return;
+    }
+
+    // Everything else goes through 65536-bit bitsets, word at a time
+    dlb_bitset a_tmp = { 0 };
+    dlb_bitset b_tmp = { 0 };
+    const dlb_bitset *a_bits = &a->bitmap;
+    const dlb_bitset *b_bits = &b->bitmap;
+    if (a->type != DLB_ROARING_BITMAP) {
+        dlb_roaring__container_to_bitset(a, &a_tmp);
+        a_bits = &a_tmp;
+    }
+    if (b->type != DLB_ROARING_BITMAP) {
+        dlb_roaring__container_to_bitset(b, &b_tmp);
+        b_bits = &b_tmp;
+    }
+
+    dlb_bitset result = { 0 };
+    switch (op) {
+        case DLB_ROARING__AND:    dlb_bitset_and_into(&result, a_bits, b_bits); break;
+        case DLB_ROARING__OR:     dlb_bitset_or_into(&result, a_bits, b_bits); break;
+        case DLB_ROARING__ANDNOT: dlb_bitset_andnot_into(&result, a_bits, b_bits); break;
+        default: DLB_ASSERT(0);
+    }
+    dlb_bitset_free(&a_tmp);
+    dlb_bitset_free(&b_tmp);
+
+    u32 cardinality = dlb_bitset_popcount(&result);
+    if (!cardinality) {
+        dlb_bitset_free(&result);
+        return;
+    }
+    dlb_roaring__container_from_bitset(out, &result, cardinality);
+}
+
+//-- dlb_roaring ---------------------------------------------------------------
+
+// Index of first container with key >= key
+static size_t dlb_roaring__lower_bound(const dlb_roaring *roaring, u16 key)
+{
+    size_t lo = 0;
+    size_t hi = dlb_vec_len(roaring->containers);
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (roaring->containers[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static dlb_roaring_container *dlb_roaring__find(const dlb_roaring *roaring, u16 key)
+{
+    size_t i = dlb_roaring__lower_bound(roaring, key);
+    if (i < dlb_vec_len(roaring->containers) && roaring->containers[i].key == key) {
+        return &roaring->containers[i];
+    }
+    return 0;
+}
+
+void dlb_roaring_clear(dlb_roaring *roaring)
+{
+    dlb_vec_each(dlb_roaring_container *, c, roaring->containers) {
+        dlb_roaring__container_free(c);
+    }
+    dlb_vec_clear(roaring->containers);
+}
+
+void dlb_roaring_free(dlb_roaring *roaring)
+{
+    dlb_roaring_clear(roaring);
+    dlb_vec_free(roaring->containers);
+}
+
+int dlb_roaring_add(dlb_roaring *roaring, u32 value)
+{
+    u16 key = (u16)(value >> 16);
+    size_t i = dlb_roaring__lower_bound(roaring, key);
+    size_t len = dlb_vec_len(roaring->containers);
+    if (i == len || roaring->containers[i].key != key) {
+        dlb_vec_alloc(roaring->containers);
+        memmove(roaring->containers + i + 1, roaring->containers + i, (len - i) * sizeof(*roaring->containers));
+        dlb_roaring_container *c = &roaring->containers[i];
+        dlb_memset(c, 0, sizeof(*c));
+        c->key = key;
+        c->type = DLB_ROARING_ARRAY;
+    }
+    return dlb_roaring__container_add(&roaring->containers[i], (u16)value);
+}
+
+int dlb_roaring_remove(dlb_roaring *roaring, u32 value)
+{
+    u16 key = (u16)(value >> 16);
+    size_t i = dlb_roaring__lower_bound(roaring, key);
+    size_t len = dlb_vec_len(roaring->containers);
+    if (i == len || roaring->containers[i].key != key) {
+        return 0;
+    }
+    dlb_roaring_container *c = &roaring->containers[i];
+    if (!dlb_roaring__container_remove(c, (u16)value)) {
+        return 0;
+    }
+    if (!c->cardinality) {
+        dlb_roaring__container_free(c);
+        memmove(roaring->containers + i, roaring->containers + i + 1, (len - i - 1) * sizeof(*roaring->containers));
+        dlb_vec_pop(roaring->containers);
+    }
+    return 1;
+}
+
+bool dlb_roaring_contains(const dlb_roaring *roaring, u32 value)
+{
+    const dlb_roaring_container *c = dlb_roaring__find(roaring, (u16)(value >> 16));
+    return c && dlb_roaring__container_contains(c, (u16)value);
+}
+
+u64 dlb_roaring_cardinality(const dlb_roaring *roaring)
+{
+    u64 cardinality = 0;
+    dlb_vec_each(const dlb_roaring_container *, c, roaring->containers) {
+        cardinality += c->cardinality;
+    }
+    return cardinality;
+}
+
+void dlb_roaring_run_optimize(dlb_roaring *roaring)
+{
+    dlb_vec_each(dlb_roaring_container *, c, roaring->containers) {
+        if (c->type == DLB_ROARING_RUN) {
+            continue;
+        }
+        size_t run_bytes = dlb_roaring__container_run_count(c) * sizeof(dlb_roaring_run);
+        if (run_bytes < dlb_roaring__container_bytes(c)) {
+            dlb_roaring__container_to_runs(c);
+        }
+    }
+}
+
+static void dlb_roaring__apply(dlb_roaring__op op, dlb_roaring *dst, const dlb_roaring *a, const dlb_roaring *b)
+{
+    DLB_ASSERT(dst != a && dst != b);
+    dlb_roaring_clear(dst);
+
+    size_t a_len = dlb_vec_len(a->containers);
+    size_t b_len = dlb_vec_len(b->containers);
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a_len || j < b_len) {
+        const dlb_roaring_container *ca = i < a_len ? &a->containers[i] : 0;
+        const dlb_roaring_container *cb = j < b_len ? &b->containers[j] : 0;
+        dlb_roaring_container out = { 0 };
+
+        if (ca && cb && ca->key == cb->key) {
+            dlb_roaring__container_op(op, &out, ca, cb);
+            i++;
+            j++;
+        } else if (ca && (!cb || ca->key < cb->key)) {
+            // Key only in a
+            if (op != DLB_ROARING__AND) {
+                dlb_roaring__container_copy(&out, ca);
+            }
+            i++;
+        } else {
+            // Key only in b
+            if (op == DLB_ROARING__OR) {
+                dlb_roaring__container_copy(&out, cb);
+            }
+            j++;
+        }
+
+        if (out.cardinality) {
+            dlb_vec_push(dst->containers, out);
+        } else {
+            dlb_roaring__container_free(&out);
+        }
+    }
+}
+
+void dlb_roaring_and(dlb_roaring *dst, const dlb_roaring *a, const dlb_roaring *b)
+{
+    dlb_roaring__apply(DLB_ROARING__AND, dst, a, b);
+}
+
+void dlb_roaring_or(dlb_roaring *dst, const dlb_roaring *a, const dlb_roaring *b)
+{
+    dlb_roaring__apply(DLB_ROARING__OR, dst, a, b);
+}
+
+void dlb_roaring_andnot(dlb_roaring *dst, const dlb_roaring *a, const dlb_roaring *b)
+{
+    dlb_roaring__apply(DLB_ROARING__ANDNOT, dst, a, b);
+}
+
+//-- serialization -------------------------------------------------------------
+// All fields are native-endian:
+//
+//   u32 magic, u32 container_count
+//   per container:
+//     u16 key, u8 type, u8 pad, u32 cardinality, u32 count
+//     array:  count x u16
+//     bitmap: count x u64 (always 1024)
+//     run:    count x { u16 start, u16 length }
+
+static void dlb_roaring__write(u8 **buf, const void *data, size_t size)
+{
+    size_t offset = dlb_vec_len(*buf);
+    dlb_vec_alloc_count(*buf, size);
+    memcpy(*buf + offset, data, size);
+}
+
+void dlb_roaring_serialize(const dlb_roaring *roaring, u8 **buf)
+{
+    u32 header[2] = { DLB_ROARING__MAGIC, (u32)dlb_vec_len(roaring->containers) };
+    dlb_roaring__write(buf, header, sizeof(header));
+
+    dlb_vec_each(const dlb_roaring_container *, c, roaring->containers) {
+        u8 info[4] = { 0 };
+        memcpy(info, &c->key, sizeof(c->key));
+        info[2] = c->type;
+        u32 count = 0;
+        const void *data = 0;
+        size_t size = 0;
+        switch (c->type) {
+            case DLB_ROARING_ARRAY: {
+                count = (u32)dlb_vec_len(c->array);
+                data = c->array;
+                size = count * sizeof(*c->array);
+                break;
+            } case DLB_ROARING_BITMAP: {
+                count = c->bitmap.words;
+                data = c->bitmap.bitmaps;
+                size = count * sizeof(*c->bitmap.bitmaps);
+                break;
+            } case DLB_ROARING_RUN: {
+                count = (u32)dlb_vec_len(c->runs);
+                data = c->runs;
+                size = count * sizeof(*c->runs);
+                break;
+            } default: {
+                DLB_ASSERT(0);
+            }
+        }
+        u32 sizes[2] = { c->cardinality, count };
+        dlb_roaring__write(buf, info, sizeof(info));
+        dlb_roaring__write(buf, sizes, sizeof(sizes));
+        if (size) {
+            dlb_roaring__write(buf, data, size);
+        }
+    }
+}
+
+// Check a deserialized container's payload against the invariants every
+// other function relies on
+static bool dlb_roaring__container_valid(const dlb_roaring_container *c)
+{
+    switch (c->type) {
+        case DLB_ROARING_ARRAY: {
+            for (size_t i = 1; i < dlb_vec_len(c->array); i++) {
+                if (c->array[i] <= c->array[i - 1]) return false;
+            }
+            return true;
+        } case DLB_ROARING_BITMAP: {
+            return dlb_bitset_popcount(&c->bitmap) == c->cardinality;
+        } case DLB_ROARING_RUN: {
+            u32 cardinality = 0;
+            for (size_t i = 0; i < dlb_vec_len(c->runs); i++) {
+                u32 end = (u32)c->runs[i].start + c->runs[i].length;
+                if (end >= DLB_ROARING__BITS) return false;
+                // Sorted, non-overlapping and non-adjacent
+                if (i && c->runs[i].start <= (u32)c->runs[i - 1].start + c->runs[i - 1].length + 1) return false;
+                cardinality += (u32)c->runs[i].length + 1;
+            }
+            return cardinality == c->cardinality;
+        } default: {
+            return false;
+        }
+    }
+}
+
+bool dlb_roaring_deserialize(dlb_roaring *roaring, const void *data, size_t size)
+{
+    dlb_roaring_clear(roaring);
+
+    const u8 *cursor = (const u8 *)data;
+    const u8 *end = cursor + size;
+#define DLB_ROARING__READ(dst, bytes) \
+    if ((size_t)(end - cursor) < (size_t)(bytes)) goto malformed; \
+    memcpy((dst), cursor, (bytes)); \
+    cursor += (bytes);
+
+    u32 header[2];
+    DLB_ROARING__READ(header, sizeof(header));
+    if (header[0] != DLB_ROARING__MAGIC) goto malformed;
+
+    for (u32 i = 0; i < header[1]; i++) {
+        u8 info[4];
+        u32 sizes[2];
+        DLB_ROARING__READ(info, sizeof(info));
+        DLB_ROARING__READ(sizes, sizeof(sizes));
+
+        dlb_roaring_container c = { 0 };
+        memcpy(&c.key, info, sizeof(c.key));
+        c.type = info[2];
+        c.cardinality = sizes[0];
+        u32 count = sizes[1];
+        if (!c.cardinality || c.cardinality > DLB_ROARING__BITS) goto malformed;
+        if (dlb_vec_len(roaring->containers) && dlb_vec_last(roaring->containers)->key >= c.key) goto malformed;
+
+        switch (c.type) {
+            case DLB_ROARING_ARRAY: {
+                if (count != c.cardinality || count > DLB_ROARING_ARRAY_MAX) goto malformed;
+                dlb_vec_alloc_count(c.array, count);
+                dlb_vec_push(roaring->containers, c);
+                DLB_ROARING__READ(c.array, count * sizeof(*c.array));
+                break;
+            } case DLB_ROARING_BITMAP: {
+                if (count != DLB_ROARING__BITS / 64) goto malformed;
+                dlb_bitset_reserve(&c.bitmap, DLB_ROARING__BITS);
+                dlb_vec_push(roaring->containers, c);
+                DLB_ROARING__READ(c.bitmap.bitmaps, count * sizeof(*c.bitmap.bitmaps));
+                break;
+            } case DLB_ROARING_RUN: {
+                if (!count || count > DLB_ROARING__BITS / 2) goto malformed;
+                dlb_vec_alloc_count(c.runs, count);
+                dlb_vec_push(roaring->containers, c);
+                DLB_ROARING__READ(c.runs, count * sizeof(*c.runs));
+                break;
+            } default: {
+                goto malformed;
+            }
+        }
+        if (!dlb_roaring__container_valid(dlb_vec_last(roaring->containers))) goto malformed;
+    }
+#undef DLB_ROARING__READ
+    return true;
+
+malformed:
+    dlb_roaring_clear(roaring);
+    return false;
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_ROARING_TEST
+
+// Deserialize buf with `size` bytes at `offset` overwritten, then restore it
+static bool dlb_roaring__test_patched(u8 *buf, size_t offset, const void *patch, size_t size)
+{
+    u8 saved[8];
+    DLB_ASSERT(size <= sizeof(saved) && offset + size <= dlb_vec_len(buf));
+    memcpy(saved, buf + offset, size);
+    memcpy(buf + offset, patch, size);
+    dlb_roaring r = { 0 };
+    bool ok = dlb_roaring_deserialize(&r, buf, dlb_vec_len(buf));
+    DLB_ASSERT(ok || !dlb_vec_len(r.containers));
+    dlb_roaring_free(&r);
+    memcpy(buf + offset, saved, size);
+    return ok;
+}
+
+void dlb_roaring_test()
+{
+    dlb_roaring a = { 0 };
+    dlb_roaring b = { 0 };
+    dlb_roaring c = { 0 };
+
+    // a: sparse values in two chunks, plus a dense chunk (bitmap container)
+    DLB_ASSERT(dlb_roaring_add(&a, 7));
+    DLB_ASSERT(!dlb_roaring_add(&a, 7));
+    DLB_ASSERT(dlb_roaring_add(&a, 0xFFFFFFFF));
+    for (u32 i = 0; i < 10000; i++) {
+        dlb_roaring_add(&a, 0x10000 + i * 2);
+    }
+    DLB_ASSERT(dlb_roaring_cardinality(&a) == 10002);
+    DLB_ASSERT(dlb_roaring_contains(&a, 7));
+    DLB_ASSERT(dlb_roaring_contains(&a, 0x10000 + 19998));
+    DLB_ASSERT(!dlb_roaring_contains(&a, 0x10001));
+    DLB_ASSERT(!dlb_roaring_contains(&a, 8));
+
+    // b: one long range, becomes a run container
+    for (u32 i = 0; i < 20000; i++) {
+        dlb_roaring_add(&b, 0x10000 + i);
+    }
+    dlb_roaring_add(&b, 7);
+    dlb_roaring_run_optimize(&b);
+    DLB_ASSERT(b.containers[1].type == DLB_ROARING_RUN);
+    DLB_ASSERT(dlb_roaring_contains(&b, 0x10000 + 12345));
+    DLB_ASSERT(dlb_roaring_remove(&b, 0x10000 + 12345));  // split run
+    DLB_ASSERT(!dlb_roaring_contains(&b, 0x10000 + 12345));
+    DLB_ASSERT(dlb_roaring_add(&b, 0x10000 + 12345));     // merge runs
+    DLB_ASSERT(dlb_vec_len(b.containers[1].runs) == 1);
+
+    dlb_roaring_and(&c, &a, &b);
+    DLB_ASSERT(dlb_roaring_cardinality(&c) == 10001);
+    dlb_roaring_or(&c, &a, &b);
+    DLB_ASSERT(dlb_roaring_cardinality(&c) == 20002);
+    dlb_roaring_andnot(&c, &b, &a);
+    DLB_ASSERT(dlb_roaring_cardinality(&c) == 10000);
+    DLB_ASSERT(!dlb_roaring_contains(&c, 7));
+    DLB_ASSERT(dlb_roaring_contains(&c, 0x10001));
+
+    // Round trip
+    u8 *buf = 0;
+    dlb_roaring_serialize(&b, &buf);
+    dlb_roaring_free(&c);
+    DLB_ASSERT(dlb_roaring_deserialize(&c, buf, dlb_vec_len(buf)));
+    DLB_ASSERT(dlb_roaring_cardinality(&c) == dlb_roaring_cardinality(&b));
+    DLB_ASSERT(dlb_roaring_contains(&c, 0x10000 + 19999));
+    DLB_ASSERT(!dlb_roaring_deserialize(&c, buf, dlb_vec_len(buf) - 1));
+
+    // Payloads that disagree with their header are rejected. b is a 1-value
+    // array container, then the run container at offset 22: cardinality at
+    // 26, run [0, 19999] at 34.
+    DLB_ASSERT(dlb_roaring__test_patched(buf, 0, buf, 0));
+    u32 cardinality = 20001;
+    DLB_ASSERT(!dlb_roaring__test_patched(buf, 26, &cardinality, sizeof(cardinality)));
+    dlb_roaring_run past_end = { 0xFF00, 19999 };
+    DLB_ASSERT(!dlb_roaring__test_patched(buf, 34, &past_end, sizeof(past_end)));
+    dlb_vec_clear(buf);
+
+    // Overlapping runs
+    dlb_roaring d = { 0 };
+    for (u32 i = 0; i < 100; i++) {
+        dlb_roaring_add(&d, i < 50 ? i : i + 10);
+    }
+    dlb_roaring_run_optimize(&d);
+    DLB_ASSERT(d.containers[0].type == DLB_ROARING_RUN);
+    dlb_roaring_serialize(&d, &buf);
+    dlb_roaring_run overlap = { 40, 59 };
+    DLB_ASSERT(!dlb_roaring__test_patched(buf, 24, &overlap, sizeof(overlap)));
+    dlb_roaring_run adjacent = { 50, 49 };
+    DLB_ASSERT(!dlb_roaring__test_patched(buf, 24, &adjacent, sizeof(adjacent)));
+    dlb_vec_clear(buf);
+
+    // Duplicate array values
+    dlb_roaring_clear(&d);
+    dlb_roaring_add(&d, 1);
+    dlb_roaring_add(&d, 2);
+    dlb_roaring_serialize(&d, &buf);
+    u16 dup = 1;
+    DLB_ASSERT(!dlb_roaring__test_patched(buf, 22, &dup, sizeof(dup)));
+    dlb_vec_clear(buf);
+    dlb_roaring_free(&d);
+
+    // Bitmap whose popcount doesn't match: a's bitmap container is at 22
+    dlb_roaring_serialize(&a, &buf);
+    DLB_ASSERT(dlb_roaring__test_patched(buf, 0, buf, 0));
+    u8 extra_bit = 0x57;  // even values are set, this adds 0x10001
+    DLB_ASSERT(!dlb_roaring__test_patched(buf, 34, &extra_bit, sizeof(extra_bit)));
+    dlb_vec_free(buf);
+
+    // Remove until empty drops containers
+    for (u32 i = 0; i < 10000; i++) {
+        DLB_ASSERT(dlb_roaring_remove(&a, 0x10000 + i * 2));
+    }
+    DLB_ASSERT(dlb_vec_len(a.containers) == 2);
+
+    dlb_roaring_free(&a);
+    dlb_roaring_free(&b);
+    dlb_roaring_free(&c);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
@@ -0,0 +1,460 @@
+#ifndef DLB_TIMER_WHEEL_H
+#define DLB_TIMER_WHEEL_H
+//------------------------------------------------------------------------------
+// Copyright 2026 Dan Bechard
+//------------------------------------------------------------------------------
+
+//-- documentation -------------------------------------------------------------
+// Hashed hierarchical timer wheel. Time is measured in caller-defined ticks.
+//
+// Level 0 has one slot per tick, each higher level has slots 64x wider than the
+// level below it. A timer is hashed into the lowest level that can represent
+// its distance from `now`. Every time a level wraps around, the next slot of
+// the level above it is cascaded (re-hashed) into the lower levels. Timers
+// beyond the last level's horizon (2^24 ticks) live in a dlb_heap and are
+// pulled into the wheel once they come within range.
+//
+//   schedule: O(1)
+//   cancel:   O(1) (timers in the overflow heap are discarded lazily)
+//   advance:  O(expired + cascaded + non-empty slots passed); empty slots are
+//             skipped using a per-level occupancy bitmap
+//
+// Example usage:
+#if 0
+    dlb_timer_wheel wheel = { 0 };
+    dlb_timer_wheel_init(&wheel, now_ms);
+    dlb_timer_id id = dlb_timer_wheel_schedule(&wheel, now_ms + 5000, conn);
+    dlb_timer_wheel_cancel(&wheel, id);  // e.g. connection sent keep-alive
+
+    void **expired = 0;  // dlb_vec
+    dlb_timer_wheel_advance(&wheel, now_ms, &expired);
+    dlb_vec_each(void **, it, expired) {
+        connection_timeout((Connection *)*it);
+    }
+    dlb_vec_clear(expired);
+#endif
+
+//-- header --------------------------------------------------------------------
+#include "dlb_types.h"
+#include "dlb_vector.h"
+#include "dlb_heap.h"
+
+#define DLB_TIMER_WHEEL_SLOT_BITS 6
+#define DLB_TIMER_WHEEL_SLOTS (1 << DLB_TIMER_WHEEL_SLOT_BITS)
+#define DLB_TIMER_WHEEL_LEVELS 4
+// Timers further than this many ticks in the future go to the overflow heap
+#define DLB_TIMER_WHEEL_HORIZON_BITS (DLB_TIMER_WHEEL_SLOT_BITS * DLB_TIMER_WHEEL_LEVELS)
+
+#if DLB_TIMER_WHEEL_SLOTS != 64
+#error "dlb_timer_wheel.occupied needs one u64 bit per slot"
+#endif
+
+// (generation << 32) | (index + 1), 0 is never a valid timer
+typedef u64 dlb_timer_id;
+#define DLB_TIMER_INVALID 0
+
+typedef struct dlb_timer {
+    u64 expires;       // absolute tick
+    void *data;        // user data returned when the timer expires
+    u32 generation;    // incremented every time the timer is released
+    u32 bucket;        // index into wheel->buckets, or one of the DLB_TIMER__* states
+    u32 bucket_index;  // position within the bucket, for O(1) swap-remove
+    u32 next_free;     // free list link (index + 1), 0 = end of list
+} dlb_timer;
+
+typedef struct dlb_timer_wheel {
+    u64 now;                 // current tick, only moves forward
+    dlb_timer *timers;       // dlb_vec, pool of timers indexed by dlb_timer_id
+    u32 free_list;           // head of free list (index + 1), 0 = empty
+    size_t count;            // # of scheduled timers (wheel + overflow)
+    size_t wheel_count;      // # of timers currently hashed into buckets
+    // dlb_vec of timer indices per slot, level-major
+    u32 *buckets[DLB_TIMER_WHEEL_LEVELS * DLB_TIMER_WHEEL_SLOTS];
+    // Bit i of occupied[level] is set iff that level's slot i is non-empty
+    u64 occupied[DLB_TIMER_WHEEL_LEVELS];
+    dlb_heap overflow;       // far-future timers, data is (index + 1)
+} dlb_timer_wheel;
+
+void dlb_timer_wheel_init(dlb_timer_wheel *wheel, u64 now);
+void dlb_timer_wheel_free(dlb_timer_wheel *wheel);
+// Schedule `data` to expire at absolute tick `expires`. Timers that are already
+// due will expire on the next call to dlb_timer_wheel_advance.
+dlb_timer_id dlb_timer_wheel_schedule(dlb_timer_wheel *wheel, u64 expires, void *data);
+// Returns 1 if the timer was cancelled, 0 if it already expired or was cancelled
+int dlb_timer_wheel_cancel(dlb_timer_wheel *wheel, dlb_timer_id id);
+// Advance the wheel to `now`, pushing the data of every expired timer onto the
+// `expired` dlb_vec in order of expiry tick. Returns # of expired timers.
+size_t dlb_timer_wheel_advance(dlb_timer_wheel *wheel, u64 now, void ***expired);
+
+void dlb_timer_wheel_test();
+
+#endif
+//-- end of header -------------------------------------------------------------
+
+#ifdef __INTELLISENSE__
+/* This makes MSVC intellisense work. */
+#define DLB_TIMER_WHEEL_IMPLEMENTATION
+#endif
+
+//-- implementation ------------------------------------------------------------
+#ifdef DLB_TIMER_WHEEL_IMPLEMENTATION
+#ifndef DLB_TIMER_WHEEL_IMPL_INTERNAL
+#define DLB_TIMER_WHEEL_IMPL_INTERNAL
+
+#define DLB_TIMER__FREE      0xFFFFFFFF
+#define DLB_TIMER__OVERFLOW  0xFFFFFFFE
+#define DLB_TIMER__CANCELLED 0xFFFFFFFD
+
+#define DLB_TIMER_WHEEL__SLOT_MASK (DLB_TIMER_WHEEL_SLOTS - 1)
+// Overflow timers are ordered by which top-level slot they fall into, and are
+// pulled into the wheel each time the tick crosses a top-level slot boundary
+#define DLB_TIMER_WHEEL__OVERFLOW_SHIFT (DLB_TIMER_WHEEL_HORIZON_BITS - DLB_TIMER_WHEEL_SLOT_BITS)
+
+static inline u32 dlb_timer_wheel__id_index(dlb_timer_id id)
+{
+    return (u32)(id & 0xFFFFFFFF) - 1;
+}
+
+static inline u32 dlb_timer_wheel__id_generation(dlb_timer_id id)
+{
+    return (u32)(id >> 32);
+}
+
+// dlb_heap is a max-heap with priorities > 0, so the earliest slot gets the
+// largest priority
+static inline u32 dlb_timer_wheel__overflow_priority(u64 expires)
+{
+    u64 slot = expires >> DLB_TIMER_WHEEL__OVERFLOW_SHIFT;
+    DLB_ASSERT(slot < UINT32_MAX);  // Expiry too far in the future
+    return UINT32_MAX - (u32)slot;
+}
+
+void dlb_timer_wheel_init(dlb_timer_wheel *wheel, u64 now)
+{
+    dlb_memset(wheel, 0, sizeof(*wheel));
+    wheel->now = now;
+    dlb_heap_init(&wheel->overflow);
+}
+
+void dlb_timer_wheel_free(dlb_timer_wheel *wheel)
+{
+    for (u32 i = 0; i < ARRAY_SIZE(wheel->buckets); i++) {
+        dlb_vec_free(wheel->buckets[i]);
+    }
+    dlb_vec_free(wheel->timers);
+    dlb_heap_free(&wheel->overflow);
+    dlb_memset(wheel, 0, sizeof(*wheel));
+}
+
+static u32 dlb_timer_wheel__alloc(dlb_timer_wheel *wheel)
+{
+    u32 index;
+    if (wheel->free_list) {
+        index = wheel->free_list - 1;
+        wheel->free_list = wheel->timers[index].next_free;
+    } else {
+        DLB_ASSERT(dlb_vec_len(wheel->timers) < UINT32_MAX - 1);
+        index = (u32)dlb_vec_len(wheel->timers);
+        dlb_vec_alloc(wheel->timers);
+    }
+    return index;
+}
+
+static void dlb_timer_wheel__release(dlb_timer_wheel *wheel, u32 index)
+{
+    dlb_timer *timer = &wheel->timers[index];
+    if (timer->bucket != DLB_TIMER__CANCELLED) {
+        // Cancelled timers have already invalidated their id
+        timer->generation++;
+    }
+    timer->data = 0;
+    timer->bucket = DLB_TIMER__FREE;
+    timer->next_free = wheel->free_list;
+    wheel->free_list = index + 1;
+}
+
+// Hash timer into the lowest level that can hold it, or the overflow heap.
+// `earliest` is the first tick whose level 0 slot has not been processed yet.
+static void dlb_timer_wheel__place(dlb_timer_wheel *wheel, u32 index, u64 earliest)
+{
+    dlb_timer *timer = &wheel->timers[index];
+    u64 expires = MAX(timer->expires, earliest);
+    u64 delta = expires - wheel->now;
+
+    if (delta >> DLB_TIMER_WHEEL_HORIZON_BITS) {
+        timer->bucket = DLB_TIMER__OVERFLOW;
+        u32 priority = dlb_timer_wheel__overflow_priority(expires);
+        dlb_heap_push(&wheel->overflow, priority, (void *)(uintptr_t)(index + 1));
+        return;
+    }
+
+    u32 level = 0;
+    while (delta >> (DLB_TIMER_WHEEL_SLOT_BITS * (level + 1))) {
+        level++;
+    }
+    u32 slot = (u32)(expires >> (DLB_TIMER_WHEEL_SLOT_BITS * level)) & DLB_TIMER_WHEEL__SLOT_MASK;
+    u32 bucket = level * DLB_TIMER_WHEEL_SLOTS + slot;
+
+    timer->bucket = bucket;
+    timer->bucket_index = (u32)dlb_vec_len(wheel->buckets[bucket]);
+    dlb_vec_push(wheel->buckets[bucket], index);
+    wheel->occupied[level] |= (u64)1 << slot;
+    wheel->wheel_count++;
+}
+
+static inline void dlb_timer_wheel__mark_empty(dlb_timer_wheel *wheel, u32 bucket)
+{
+    wheel->occupied[bucket / DLB_TIMER_WHEEL_SLOTS] &= ~((u64)1 << (bucket & DLB_TIMER_WHEEL__SLOT_MASK));
+}
+
+static void dlb_timer_wheel__unlink(dlb_timer_wheel *wheel, u32 index)
+{
+    dlb_timer *timer = &wheel->timers[index];
+    u32 *bucket = wheel->buckets[timer->bucket];
+    size_t last = dlb_vec_len(bucket) - 1;
+    if (timer->bucket_index != last) {
+        u32 moved = bucket[last];
+        bucket[timer->bucket_index] = moved;
+        wheel->timers[moved].bucket_index = timer->bucket_index;
+    }
+    dlb_vec_pop(bucket);
+    if (!dlb_vec_len(bucket)) {
+        dlb_timer_wheel__mark_empty(wheel, timer->bucket);
+    }
+    wheel->wheel_count--;
+}
+
+dlb_timer_id dlb_timer_wheel_schedule(dlb_timer_wheel *wheel, u64 expires, void *data)
+{
+    u32 index = dlb_timer_wheel__alloc(wheel);
+    dlb_timer *timer = &wheel->timers[index];
+    timer->expires = expires;
+    timer->data = data;
+    timer->next_free = 0;
+    dlb_timer_wheel__place(wheel, index, wheel->now + 1);
+    wheel->count++;
+
+    dlb_timer_id id = ((u64)timer->generation << 32) | (index + 1);
+    return id;
+}
+
+int dlb_timer_wheel_cancel(dlb_timer_wheel *wheel, dlb_timer_id id)
+{
+    if (id == DLB_TIMER_INVALID) {
+        return 0;
+    }
+    u32 index = dlb_timer_wheel__id_index(id);
+    if (index >= dlb_vec_len(wheel->timers)) {
+        return 0;
+    }
+    dlb_timer *timer = &wheel->timers[index];
+    if (timer->generation != dlb_timer_wheel__id_generation(id)) {
+        return 0;
+    }
+
+    switch (timer->bucket) {
+        case DLB_TIMER__FREE: case DLB_TIMER__CANCELLED: {
+            return 0;
+        } case DLB_TIMER__OVERFLOW: {
+            // Can't remove from the middle of the heap, release when popped
+            timer->bucket = DLB_TIMER__CANCELLED;
+            timer->data = 0;
+            timer->generation++;
+            break;
+        } default: {
+            dlb_timer_wheel__unlink(wheel, index);
+            dlb_timer_wheel__release(wheel, index);
+        }
+    }
+    wheel->count--;
+    return 1;
+}
+
+// Move every overflow timer whose top-level slot is within the horizon into
+// the wheel. Called on every top-level slot boundary.
+static void dlb_timer_wheel__pull_overflow(dlb_timer_wheel *wheel)
+{
+    u64 last_slot = (wheel->now >> DLB_TIMER_WHEEL__OVERFLOW_SHIFT) + DLB_TIMER_WHEEL__SLOT_MASK;
+    u32 min_priority = dlb_timer_wheel__overflow_priority(last_slot << DLB_TIMER_WHEEL__OVERFLOW_SHIFT);
+
+    while (dlb_heap_peek_priority(&wheel->overflow) >= min_priority) {
+        u32 index = (u32)(uintptr_t)dlb_heap_pop(&wheel->overflow) - 1;
+        if (wheel->timers[index].bucket == DLB_TIMER__CANCELLED) {
+            // Already counted as cancelled, just recycle it
+            dlb_timer_wheel__release(wheel, index);
+            continue;
+        }
+        dlb_timer_wheel__place(wheel, index, wheel->now);
+    }
+}
+
+// Re-hash every timer in a slot into the lower levels
+static void dlb_timer_wheel__cascade(dlb_timer_wheel *wheel, u32 bucket)
+{
+    u32 *timers = wheel->buckets[bucket];
+    size_t len = dlb_vec_len(timers);
+    if (!len) {
+        return;
+    }
+    // Detach the slot so placement can never append to the vector being walked
+    wheel->buckets[bucket] = 0;
+    dlb_timer_wheel__mark_empty(wheel, bucket);
+    wheel->wheel_count -= len;
+    for (size_t i = 0; i < len; i++) {
+        dlb_timer_wheel__place(wheel, timers[i], wheel->now);
+    }
+    DLB_ASSERT(!wheel->buckets[bucket]);
+    dlb_vec_clear(timers);
+    wheel->buckets[bucket] = timers;
+}
+
+static size_t dlb_timer_wheel__tick(dlb_timer_wheel *wheel, void ***expired)
+{
+    wheel->now++;
+    u64 now = wheel->now;
+
+    if (!(now & (((u64)1 << DLB_TIMER_WHEEL__OVERFLOW_SHIFT) - 1))) {
+        dlb_timer_wheel__pull_overflow(wheel);
+    }
+
+    // Cascade higher levels each time the level below them wraps around
+    for (u32 level = 1; level < DLB_TIMER_WHEEL_LEVELS; level++) {
+        u32 shift = DLB_TIMER_WHEEL_SLOT_BITS * level;
+        if (now & (((u64)1 << shift) - 1)) {
+            break;
+        }
+        u32 slot = (u32)(now >> shift) & DLB_TIMER_WHEEL__SLOT_MASK;
+        dlb_timer_wheel__cascade(wheel, level * DLB_TIMER_WHEEL_SLOTS + slot);
+    }
+
+    u32 bucket = (u32)now & DLB_TIMER_WHEEL__SLOT_MASK;
+    u32 *timers = wheel->buckets[bucket];
+    size_t len = dlb_vec_len(timers);
+    if (!len) {
+        return 0;
+    }
+
+    size_t fired = 0;
+    wheel->buckets[bucket] = 0;
+    dlb_timer_wheel__mark_empty(wheel, bucket);
+    wheel->wheel_count -= len;
+    for (size_t i = 0; i < len; i++) {
+        u32 index = timers[i];
+        dlb_timer *timer = &wheel->timers[index];
+        if (timer->expires > now) {
+            // NOTE: Shouldn't happen, level 0 only holds timers < 64 ticks out
+            dlb_timer_wheel__place(wheel, index, now + 1);
+            continue;
+        }
+        dlb_vec_push(*expired, timer->data);
+        dlb_timer_wheel__release(wheel, index);
+        fired++;
+    }
+    dlb_vec_clear(timers);
+    if (wheel->buckets[bucket]) {
+        dlb_vec_free(timers);
+    } else {
+        wheel->buckets[bucket] = timers;
+    }
+    wheel->count -= fired;
+    return fired;
+}
+
+// First tick after wheel->now at which a tick does any work: a level 0 slot
+// with timers in it comes due, a non-empty higher-level slot is cascaded, or
+// the overflow heap is checked. Every tick before it is a no-op.
+static u64 dlb_timer_wheel__next_tick(dlb_timer_wheel *wheel)
+{
+    u64 next = UINT64_MAX;
+    if (!dlb_heap_empty(&wheel->overflow)) {
+        next = ((wheel->now >> DLB_TIMER_WHEEL__OVERFLOW_SHIFT) + 1) << DLB_TIMER_WHEEL__OVERFLOW_SHIFT;
+    }
+    for (u32 level = 0; level < DLB_TIMER_WHEEL_LEVELS; level++) {
+        u64 occupied = wheel->occupied[level];
+        if (!occupied) {
+            continue;
+        }
+        // Slot k steps past the current one is reached (level 0) or cascaded
+        // (higher levels) at the start of that slot's range, k in [1, 64]
+        u32 shift = DLB_TIMER_WHEEL_SLOT_BITS * level;
+        u64 current = wheel->now >> shift;
+        u32 rotate = ((u32)current + 1) & DLB_TIMER_WHEEL__SLOT_MASK;
+        u64 rotated = rotate ? (occupied >> rotate) | (occupied << (DLB_TIMER_WHEEL_SLOTS - rotate)) : occupied;
+        u64 tick = (current + dlb_ctz64(rotated) + 1) << shift;
+        next = MIN(next, tick);
+    }
+    return next;
+}
+
+size_t dlb_timer_wheel_advance(dlb_timer_wheel *wheel, u64 now, void ***expired)
+{
+    size_t fired = 0;
+    while (wheel->now < now) {
+        u64 next = dlb_timer_wheel__next_tick(wheel);
+        if (next > now) {
+            wheel->now = now;
+            break;
+        }
+        wheel->now = next - 1;
+        fired += dlb_timer_wheel__tick(wheel, expired);
+    }
+    return fired;
+}
+
+#endif
+#endif
+//-- end of implementation -----------------------------------------------------
+
+//-- tests ---------------------------------------------------------------------
+#ifdef DLB_TIMER_WHEEL_TEST
+
+void dlb_timer_wheel_test()
+{
+    dlb_timer_wheel wheel = { 0 };
+    dlb_timer_wheel_init(&wheel, 100);
+
+    // One timer per level, plus one in the overflow heap
+    u64 delays[] = { 0, 2, 63, 64, 4095, 4096, 300000, ((u64)1 << 24) + 12345 };
+    dlb_timer_id ids[ARRAY_SIZE(delays)] = { 0 };
+    for (u32 i = 0; i < ARRAY_SIZE(delays); i++) {
+        ids[i] = dlb_timer_wheel_schedule(&wheel, 100 + delays[i], (void *)(uintptr_t)(i + 1));
+    }
+    DLB_ASSERT(wheel.count == ARRAY_SIZE(delays));
+
+    void **expired = 0;
+    for (u32 i = 0; i < ARRAY_SIZE(delays); i++) {
+        u64 due = MAX(100 + delays[i], 101);
+        dlb_vec_clear(expired);
+        dlb_timer_wheel_advance(&wheel, due - 1, &expired);
+        DLB_ASSERT(dlb_vec_len(expired) == 0);
+        dlb_timer_wheel_advance(&wheel, due, &expired);
+        DLB_ASSERT(dlb_vec_len(expired) == 1);
+        DLB_ASSERT(expired[0] == (void *)(uintptr_t)(i + 1));
+    }
+    DLB_ASSERT(wheel.count == 0);
+    DLB_ASSERT(!dlb_timer_wheel_cancel(&wheel, ids[0]));
+    for (u32 level = 0; level < DLB_TIMER_WHEEL_LEVELS; level++) {
+        DLB_ASSERT(!wheel.occupied[level]);
+    }
+
+    // Cancel from the wheel and from the overflow heap
+    u64 now = wheel.now;
+    dlb_timer_id near = dlb_timer_wheel_schedule(&wheel, now + 10, (void *)1);
+    dlb_timer_id far = dlb_timer_wheel_schedule(&wheel, now + ((u64)1 << 25), (void *)2);
+    dlb_timer_id keep = dlb_timer_wheel_schedule(&wheel, now + 1000, (void *)3);
+    DLB_ASSERT(dlb_timer_wheel_cancel(&wheel, near));
+    DLB_ASSERT(dlb_timer_wheel_cancel(&wheel, far));
+    DLB_ASSERT(!dlb_timer_wheel_cancel(&wheel, far));
+    dlb_vec_clear(expired);
+    dlb_timer_wheel_advance(&wheel, now + ((u64)1 << 26), &expired);
+    DLB_ASSERT(dlb_vec_len(expired) == 1);
+    DLB_ASSERT(expired[0] == (void *)3);
+    DLB_ASSERT(!dlb_timer_wheel_cancel(&wheel, keep));
+    DLB_ASSERT(wheel.count == 0);
+
+    dlb_vec_free(expired);
+    dlb_timer_wheel_free(&wheel);
+}
+
+#endif
+//-- end of tests --------------------------------------------------------------
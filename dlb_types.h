@@ -117,6 +117,45 @@ static inline u32 endian_swap_u32(u32 val)
                  ((val & 0x000000FF) << 24));
 }
 
+// Bit twiddling
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Returns # of set bits in x
+static inline u32 dlb_popcount64(u64 x)
+{
+#if defined(_MSC_VER)
+    return (u32)__popcnt64(x);
+#else
+    return (u32)__builtin_popcountll(x);
+#endif
+}
+
+// Returns index of lowest set bit in x (tzcnt). x must be non-zero.
+static inline u32 dlb_ctz64(u64 x)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (u32)index;
+#else
+    return (u32)__builtin_ctzll(x);
+#endif
+}
+
+// Returns # of leading zero bits in x (lzcnt). x must be non-zero.
+static inline u32 dlb_clz64(u64 x)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (u32)index;
+#else
+    return (u32)__builtin_clzll(x);
+#endif
+}
+
 static inline void swap_r32(r32 *a, r32 *b)
 {
     r32 t = *a;